@@ -0,0 +1,40 @@
+/**
+ * @file   file.h
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Header file for file function declarations.
+ *
+ *
+ */
+
+#ifndef RINOO_FS_FILE_H_
+#define RINOO_FS_FILE_H_
+
+/* Maximum size of a single read or write */
+#define RN_FILE_IO_MAX	(1 << 30)
+
+/*
+ * File operations suspend the calling task, not the scheduler.
+ * They complete through io_uring when the scheduler uses the
+ * io_uring poller, or through the offload pool otherwise.
+ * A file is not tied to a scheduler, each operation uses the
+ * scheduler of the calling task.
+ */
+typedef struct rn_file_s {
+	int fd;
+	off_t offset;
+} rn_file_t;
+
+rn_file_t *rn_file_open(rn_sched_t *sched, const char *path, int flags, mode_t mode);
+int rn_file_close(rn_file_t *file);
+int rn_file_stat(rn_file_t *file, struct stat *stats);
+ssize_t rn_file_read(rn_file_t *file, void *buf, size_t count);
+ssize_t rn_file_write(rn_file_t *file, const void *buf, size_t count);
+ssize_t rn_file_pread(rn_file_t *file, void *buf, size_t count, off_t offset);
+ssize_t rn_file_pwrite(rn_file_t *file, const void *buf, size_t count, off_t offset);
+int rn_file_fsync(rn_file_t *file);
+ssize_t rn_file_readb(rn_file_t *file, rn_buffer_t *buffer);
+ssize_t rn_file_writeb(rn_file_t *file, rn_buffer_t *buffer);
+
+#endif /* !RINOO_FS_FILE_H_ */
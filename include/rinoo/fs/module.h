@@ -12,6 +12,7 @@
 #define RINOO_MODULE_FS_H_
 
 #include <errno.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <dirent.h>
 #include <sys/stat.h>
@@ -24,6 +25,7 @@
 #include "rinoo/scheduler/module.h"
 
 #include "rinoo/fs/browse.h"
+#include "rinoo/fs/file.h"
 #include "rinoo/fs/inotify.h"
 
 #endif /* !RINOO_MODULE_FS_H_ */
@@ -11,6 +11,10 @@
 #ifndef RINOO_MODULE_GLOBAL_H_
 #define RINOO_MODULE_GLOBAL_H_
 
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
 #include <time.h>
 #include <stdio.h>
 #include <ctype.h>
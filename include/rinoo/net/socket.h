@@ -37,6 +37,7 @@ int rn_addr6(rn_addr_t *dest, const char *src, uint16_t port);
 int rn_socket_init(rn_sched_t *sched, rn_socket_t *sock, const rn_socket_class_t *class);
 rn_socket_t *rn_socket(rn_sched_t *sched, const rn_socket_class_t *class);
 rn_socket_t *rn_socket_dup(rn_sched_t *destination, rn_socket_t *socket);
+int rn_socket_migrate(rn_sched_t *destination, rn_socket_t *socket);
 void rn_socket_close(rn_socket_t *socket);
 void rn_socket_destroy(rn_socket_t *socket);
 
@@ -46,6 +47,7 @@ int rn_socket_waitin(rn_socket_t *socket);
 int rn_socket_waitout(rn_socket_t *socket);
 int rn_socket_waitio(rn_socket_t *socket);
 int rn_socket_timeout(rn_socket_t *socket, uint32_t ms);
+int rn_socket_busypoll(rn_socket_t *socket, uint32_t us);
 
 int rn_socket_connect(rn_socket_t *socket, const rn_addr_t *dst);
 int rn_socket_bind(rn_socket_t *socket, const rn_addr_t *dst, int backlog);
@@ -15,5 +15,6 @@
 
 rn_socket_t *rn_tcp_client(rn_sched_t *sched, rn_addr_t *dst, uint32_t timeout);
 rn_socket_t *rn_tcp_server(rn_sched_t *sched, rn_addr_t *dst);
+int rn_tcp_dispatch(rn_sched_t *sched, rn_addr_t *dst, void (*function)(void *socket));
 
 #endif /* !RINOO_NET_TCP_H_ */
@@ -14,6 +14,9 @@
 #define RN_HTTP_ERROR_500	"<div style=\"display: inline-block; border-radius: 4px; border: 1px solid red; width: 16px; height: 16px; color: red; font-size: 14px; text-align: center;\">&#10060;</div> <span style=\"font-family: Arial;\">500 - Internal server error</span>"
 #define RN_HTTP_ERROR_404	"<div style=\"display: inline-block; border-radius: 4px; border: 1px solid orange; width: 16px; height: 16px; color: orange; font-size: 14px; text-align: center;\">?</div> <span style=\"font-family: Arial;\">404 - Not found</span>"
 
+/* Idle time before a keep-alive connection gets parked, in ms */
+#define RN_HTTP_EASY_IDLE	1000
+
 typedef enum rn_http_route_type_e {
 	RN_HTTP_ROUTE_STATIC = 0,
 	RN_HTTP_ROUTE_FUNC,
@@ -11,6 +11,8 @@
 #ifndef		RINOO_PROTO_HTTP_FILE_H_
 # define	RINOO_PROTO_HTTP_FILE_H_
 
+# define	RN_HTTP_FILE_CHUNK	(64 * 1024)
+
 int rn_http_send_dir(rn_http_t *http, const char *path);
 int rn_http_send_file(rn_http_t *http, const char *path);
 
@@ -27,6 +27,7 @@
 #include "rinoo/struct/module.h"
 #include "rinoo/scheduler/module.h"
 #include "rinoo/net/module.h"
+#include "rinoo/fs/module.h"
 
 #include "rinoo/proto/http/http_header.h"
 #include "rinoo/proto/http/http_request.h"
@@ -0,0 +1,47 @@
+/**
+ * @file   bchannel.h
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Header file for buffered channel function declarations.
+ *
+ *
+ */
+
+#ifndef RINOO_SCHEDULER_BCHANNEL_H_
+#define RINOO_SCHEDULER_BCHANNEL_H_
+
+/*
+ * A buffered channel holds up to `capacity` pointers in a ring buffer.
+ * Writers only block when the ring is full and readers when it is
+ * empty, so that messages get batched instead of being handed over
+ * one at a time. All tasks using it must run on the channel scheduler.
+ */
+typedef struct rn_bchannel_s {
+	void **ring;
+	uint32_t head;
+	uint32_t count;
+	uint32_t capacity;
+	bool closed;
+	rn_list_t readers;
+	rn_list_t writers;
+	rn_sched_t *sched;
+} rn_bchannel_t;
+
+typedef struct rn_bchannel_waiter_s {
+	bool woken;
+	rn_task_t *task;
+	rn_list_node_t node;
+} rn_bchannel_waiter_t;
+
+rn_bchannel_t *rn_bchannel(rn_sched_t *sched, uint32_t capacity);
+void rn_bchannel_destroy(rn_bchannel_t *channel);
+void rn_bchannel_close(rn_bchannel_t *channel);
+int rn_bchannel_put(rn_bchannel_t *channel, void *ptr);
+void *rn_bchannel_get(rn_bchannel_t *channel);
+uint32_t rn_bchannel_size(rn_bchannel_t *channel);
+bool rn_bchannel_ready(rn_bchannel_t *channel, bool reader);
+void rn_bchannel_watch(rn_bchannel_t *channel, rn_bchannel_waiter_t *waiter, bool reader);
+void rn_bchannel_unwatch(rn_bchannel_t *channel, rn_bchannel_waiter_t *waiter, bool reader, bool forward);
+
+#endif /* !RINOO_SCHEDULER_BCHANNEL_H_ */
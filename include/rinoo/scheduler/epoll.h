@@ -11,7 +11,8 @@
 #ifndef RINOO_EPOLL_H_
 #define RINOO_EPOLL_H_
 
-#define RN_EPOLL_MAX_EVENTS	128
+#define RN_EPOLL_MIN_EVENTS	128
+#define RN_EPOLL_MAX_EVENTS	8192
 
 #include <sys/epoll.h>
 
@@ -22,9 +23,12 @@ enum rn_sched_mode_e;		/* Defined in scheduler.h */
 typedef struct rn_epoll_s {
 	int fd;
 	int curevent;
-	struct epoll_event events[RN_EPOLL_MAX_EVENTS];
+	int nbevents;
+	struct epoll_event *events;
 } rn_epoll_t;
 
+extern const rn_poller_class_t rn_poller_epoll;
+
 int rn_epoll_init(struct rn_sched_s *sched);
 void rn_epoll_destroy(struct rn_sched_s *sched);
 int rn_epoll_insert(struct rn_sched_node_s *node, enum rn_sched_mode_e mode);
@@ -0,0 +1,57 @@
+/**
+ * @file   mchannel.h
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Header file for cross-scheduler channel function declarations.
+ *
+ *
+ */
+
+#ifndef RINOO_SCHEDULER_MCHANNEL_H_
+#define RINOO_SCHEDULER_MCHANNEL_H_
+
+typedef struct rn_mchannel_cell_s {
+	uint64_t seq;
+	void *data;
+} rn_mchannel_cell_t;
+
+/*
+ * A cross-scheduler channel is a bounded lock-free MPMC ring.
+ * Tasks of any scheduler can put and get pointers without locking.
+ * The lock only protects waiting task lists: a task blocked on a
+ * channel gets woken up through its scheduler remote queue.
+ */
+typedef struct rn_mchannel_s {
+	uint64_t head __attribute__((aligned(64)));
+	uint64_t tail __attribute__((aligned(64)));
+	uint64_t mask __attribute__((aligned(64)));
+	rn_mchannel_cell_t *cells;
+	bool closed;
+	uint32_t nbreaders;
+	uint32_t nbwriters;
+	rn_list_t readers;
+	rn_list_t writers;
+	pthread_mutex_t lock;
+} rn_mchannel_t;
+
+typedef struct rn_mchannel_waiter_s {
+	bool woken;
+	bool delivered;
+	rn_task_t *task;
+	rn_list_node_t node;
+	rn_remote_msg_t msg;
+} rn_mchannel_waiter_t;
+
+rn_mchannel_t *rn_mchannel(uint32_t capacity);
+void rn_mchannel_destroy(rn_mchannel_t *channel);
+void rn_mchannel_close(rn_mchannel_t *channel);
+int rn_mchannel_tryput(rn_mchannel_t *channel, void *ptr);
+void *rn_mchannel_tryget(rn_mchannel_t *channel);
+int rn_mchannel_put(rn_mchannel_t *channel, void *ptr);
+void *rn_mchannel_get(rn_mchannel_t *channel);
+bool rn_mchannel_ready(rn_mchannel_t *channel, bool reader);
+int rn_mchannel_watch(rn_mchannel_t *channel, rn_mchannel_waiter_t *waiter, bool reader);
+void rn_mchannel_unwatch(rn_mchannel_t *channel, rn_mchannel_waiter_t *waiter, bool reader, bool forward);
+
+#endif /* !RINOO_SCHEDULER_MCHANNEL_H_ */
@@ -11,24 +11,48 @@
 #ifndef RINOO_MODULE_SCHEDULER_H_
 #define RINOO_MODULE_SCHEDULER_H_
 
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
 #include <errno.h>
+#include <sched.h>
+#include <limits.h>
 #include <signal.h>
+#include <poll.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <pthread.h>
+#include <execinfo.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
 
 #include "rinoo/debug/module.h"
 #include "rinoo/global/module.h"
 #include "rinoo/struct/module.h"
 
 #include "rinoo/scheduler/fcontext.h"
+#include "rinoo/scheduler/timer.h"
 #include "rinoo/scheduler/task.h"
 #include "rinoo/scheduler/node.h"
+#include "rinoo/scheduler/remote.h"
+#include "rinoo/scheduler/steal.h"
+#include "rinoo/scheduler/stats.h"
+#include "rinoo/scheduler/watchdog.h"
+#include "rinoo/scheduler/poller.h"
 #include "rinoo/scheduler/epoll.h"
+#include "rinoo/scheduler/uring.h"
 #include "rinoo/scheduler/spawn.h"
 #include "rinoo/scheduler/scheduler.h"
 #include "rinoo/scheduler/channel.h"
+#include "rinoo/scheduler/bchannel.h"
+#include "rinoo/scheduler/mchannel.h"
+#include "rinoo/scheduler/select.h"
+#include "rinoo/scheduler/sync.h"
+#include "rinoo/scheduler/offload.h"
 
 #endif /* !RINOO_MODULE_SCHEDULER_H_ */
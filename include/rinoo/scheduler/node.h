@@ -23,8 +23,10 @@ typedef enum rn_sched_mode_e {
 typedef struct rn_sched_node_s {
 	int fd;
 	int error;
+	uint32_t token;
 	rn_task_t *task;
 	unsigned char modes;
+	bool listening;
 	rn_list_node_t lnode;
 	struct rn_sched_s *sched;
 } rn_sched_node_t;
@@ -36,7 +38,8 @@ typedef struct rn_sched_node_s {
  * |  UNUSED   |    RECV   |   WAIT    | REGISTERED|
  *
  * `modes` holds the state of each polling mode in a scheduler node.
- * A mode must first registered (in other words, added to epoll).
+ * Both modes are registered at once (in other words, added to the poller)
+ * the first time a task waits on the node.
  * Then, when a task waits for an event on a scheduler node,
  * RiNOO sets `WAIT` field with this mode. When RiNOO receives
  * this event, it sets `RECV`. Finally, when the corresponding task resumes,
@@ -0,0 +1,64 @@
+/**
+ * @file   offload.h
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Header file for blocking call offloading function declarations.
+ *
+ *
+ */
+
+#ifndef RINOO_SCHEDULER_OFFLOAD_H_
+#define RINOO_SCHEDULER_OFFLOAD_H_
+
+#define RN_OFFLOAD_THREADS	4
+
+/* Defined in scheduler.h */
+struct rn_sched_s;
+
+/*
+ * An offloaded job runs a blocking function on a worker thread while
+ * its task is suspended. Completion goes through the task scheduler
+ * remote queue, so that the task is resumed on its own scheduler.
+ */
+typedef struct rn_offload_job_s {
+	int ret;
+	int error;
+	bool done;
+	void *arg;
+	int (*function)(void *arg);
+	uint64_t queued;
+	rn_task_t *task;
+	rn_list_node_t node;
+	rn_remote_msg_t msg;
+} rn_offload_job_t;
+
+typedef struct rn_offload_stats_s {
+	uint64_t jobs;
+	uint32_t depth;
+	uint32_t max_depth;
+	uint64_t wait_time;
+	uint64_t max_wait;
+	uint64_t run_time;
+} rn_offload_stats_t;
+
+/*
+ * The pool is shared by a scheduler and its spawns, it is owned
+ * by the main scheduler and started on first use.
+ */
+typedef struct rn_offload_s {
+	bool stop;
+	uint32_t nbthreads;
+	pthread_t *threads;
+	rn_list_t jobs;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	rn_offload_stats_t stats;
+} rn_offload_t;
+
+int rn_offload_start(struct rn_sched_s *sched, uint32_t nbthreads);
+void rn_offload_destroy(struct rn_sched_s *sched);
+void rn_offload_stats(struct rn_sched_s *sched, rn_offload_stats_t *stats);
+int rn_task_offload(struct rn_sched_s *sched, int (*function)(void *arg), void *arg);
+
+#endif /* !RINOO_SCHEDULER_OFFLOAD_H_ */
@@ -0,0 +1,28 @@
+/**
+ * @file   poller.h
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Header file for poller class definition.
+ *
+ *
+ */
+
+#ifndef RINOO_SCHEDULER_POLLER_H_
+#define RINOO_SCHEDULER_POLLER_H_
+
+struct rn_sched_s;		/* Defined in scheduler.h */
+struct rn_sched_node_s;	/* Defined in node.h */
+enum rn_sched_mode_e;		/* Defined in node.h */
+
+typedef struct rn_poller_class_s {
+	const char *name;
+	int (*init)(struct rn_sched_s *sched);
+	void (*destroy)(struct rn_sched_s *sched);
+	int (*insert)(struct rn_sched_node_s *node, enum rn_sched_mode_e mode);
+	int (*addmode)(struct rn_sched_node_s *node, enum rn_sched_mode_e mode);
+	int (*remove)(struct rn_sched_node_s *node);
+	int (*poll)(struct rn_sched_s *sched, int timeout);
+} rn_poller_class_t;
+
+#endif /* !RINOO_SCHEDULER_POLLER_H_ */
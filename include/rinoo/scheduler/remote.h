@@ -0,0 +1,39 @@
+/**
+ * @file   remote.h
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Header file for cross-scheduler message queue.
+ *
+ *
+ */
+
+#ifndef RINOO_SCHEDULER_REMOTE_H_
+#define RINOO_SCHEDULER_REMOTE_H_
+
+/* Defined in scheduler.h */
+struct rn_sched_s;
+
+typedef struct rn_remote_msg_s {
+	struct rn_remote_msg_s *next;
+	void (*handler)(struct rn_sched_s *sched, struct rn_remote_msg_s *msg);
+} rn_remote_msg_t;
+
+/*
+ * Messages are pushed by any thread on a lock-free stack and consumed
+ * in batch by the scheduler owning the queue. The eventfd is only
+ * written when a message is pushed on an empty queue, so producers
+ * pay one syscall per batch.
+ */
+typedef struct rn_remote_s {
+	rn_remote_msg_t *head;
+	rn_sched_node_t node;
+} rn_remote_t;
+
+int rn_remote_init(struct rn_sched_s *sched);
+void rn_remote_destroy(struct rn_sched_s *sched);
+int rn_remote_push(struct rn_sched_s *sched, rn_remote_msg_t *msg);
+int rn_remote_wakeup(struct rn_sched_s *sched);
+int rn_remote_process(struct rn_sched_s *sched);
+
+#endif /* !RINOO_SCHEDULER_REMOTE_H_ */
@@ -13,12 +13,40 @@
 
 typedef struct rn_sched_s {
 	int id;
+	int cpu;
+	int node;
 	bool stop;
+	bool running;
+	bool keepalive;
+	bool draining;
+	uint64_t drain_timeout;
+	uint64_t drain_deadline;
+	rn_remote_msg_t drain_msg;
 	rn_list_t nodes;
 	uint32_t nbpending;
-	struct timeval clock;
+	int64_t inflight;
+	uint64_t clock;
+	clockid_t clock_id;
 	rn_task_driver_t driver;
+	const rn_poller_class_t *poller;
+	uint64_t busypoll;
+	uint64_t lastpoll;
+	rn_sched_stats_t stats;
+	rn_sched_hist_t *hist;
+	uint64_t slow_threshold;
+	rn_stats_slow_t slow_callback;
+	bool cputime;
+	bool looptime;
+	rn_watchdog_probe_t wdog;
+	struct rn_watchdog_s *watchdog;
 	struct rn_epoll_s epoll;
+	struct rn_uring_s uring;
+	rn_remote_t remote;
+	rn_steal_t steal;
+	struct rn_offload_s *offload;
+	struct rn_sched_s *parent;
+	bool pinned;
+	cpu_set_t cpuset;
 	rn_sched_spawns_t spawns;
 } rn_sched_t;
 
@@ -28,7 +56,16 @@ int rn_scheduler_spawn(rn_sched_t *sched, int count);
 rn_sched_t *rn_scheduler_spawn_get(rn_sched_t *sched, int id);
 rn_sched_t *rn_scheduler_self(void);
 void rn_scheduler_stop(rn_sched_t *sched);
+void rn_scheduler_keepalive(rn_sched_t *sched, bool keepalive);
+void rn_scheduler_drain(rn_sched_t *sched, uint32_t ms);
+int rn_scheduler_clock_set(rn_sched_t *sched, clockid_t clock_id);
+void rn_scheduler_clock_update(rn_sched_t *sched);
+int rn_scheduler_poller_set(rn_sched_t *sched, const rn_poller_class_t *poller);
+void rn_scheduler_busypoll(rn_sched_t *sched, uint32_t us);
+int rn_scheduler_watch(rn_sched_node_t *node, rn_sched_mode_t mode);
+void rn_scheduler_unwatch(rn_sched_node_t *node, rn_sched_mode_t mode);
 int rn_scheduler_waitfor(rn_sched_node_t *node,  rn_sched_mode_t mode);
+int rn_scheduler_waitfor_cb(rn_sched_node_t *node, rn_sched_mode_t mode, void (*function)(void *arg), void *arg);
 int rn_scheduler_remove(rn_sched_node_t *node);
 void rn_scheduler_wakeup(rn_sched_node_t *node, rn_sched_mode_t mode, int error);
 int rn_scheduler_poll(rn_sched_t *sched);
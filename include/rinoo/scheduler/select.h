@@ -0,0 +1,47 @@
+/**
+ * @file   select.h
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Header file for select function declarations.
+ *
+ *
+ */
+
+#ifndef RINOO_SCHEDULER_SELECT_H_
+#define RINOO_SCHEDULER_SELECT_H_
+
+#define RN_SELECT_MAX	64
+
+typedef enum rn_select_type_e {
+	RN_SELECT_NODE = 0,
+	RN_SELECT_BCHANNEL,
+	RN_SELECT_MCHANNEL,
+} rn_select_type_t;
+
+/*
+ * A select entry is a source a task can wait on: a scheduler node,
+ * a buffered channel or a cross-scheduler channel. `mode` tells whether
+ * the task waits for reading (IN) or writing (OUT). Waiters are kept
+ * in the entry itself, so that selecting does not allocate.
+ */
+typedef struct rn_select_s {
+	rn_select_type_t type;
+	rn_sched_mode_t mode;
+	union {
+		rn_sched_node_t *node;
+		rn_bchannel_t *bchannel;
+		rn_mchannel_t *mchannel;
+	};
+	union {
+		rn_bchannel_waiter_t bwaiter;
+		rn_mchannel_waiter_t mwaiter;
+	};
+} rn_select_t;
+
+void rn_select_node(rn_select_t *entry, rn_sched_node_t *node, rn_sched_mode_t mode);
+void rn_select_bchannel(rn_select_t *entry, rn_bchannel_t *channel, rn_sched_mode_t mode);
+void rn_select_mchannel(rn_select_t *entry, rn_mchannel_t *channel, rn_sched_mode_t mode);
+int rn_select(rn_sched_t *sched, rn_select_t *entries, int count, uint32_t timeout);
+
+#endif /* !RINOO_SCHEDULER_SELECT_H_ */
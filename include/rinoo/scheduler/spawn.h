@@ -11,24 +11,57 @@
 #ifndef RINOO_SCHEDULER_SPAWN_H_
 #define RINOO_SCHEDULER_SPAWN_H_
 
+/* Elastic spawn load thresholds, in percent of loop time spent running tasks */
+#define RN_SPAWN_LOAD_HIGH	80
+#define RN_SPAWN_LOAD_LOW	20
+/* Run queue depth above which schedulers are considered loaded */
+#define RN_SPAWN_RUNQ_HIGH	64
+/* Time given to a retired spawn to finish its tasks, in ms */
+#define RN_SPAWN_RETIRE_TIMEOUT	30000
+
 /* Defined in scheduler.h */
 struct rn_sched_s;
 
+/*
+ * `run_time` and `poll_time` are the spawn statistics seen by the
+ * last elastic pool check.
+ */
 typedef struct rn_thread_s {
 	pthread_t id;
 	struct rn_sched_s *sched;
+	uint64_t run_time;
+	uint64_t poll_time;
 } rn_thread_t;
 
+typedef struct rn_spawn_elastic_s {
+	int min;
+	int max;
+	uint64_t run_time;
+	uint64_t poll_time;
+	rn_timer_t *timer;
+} rn_spawn_elastic_t;
+
 typedef struct rn_sched_spawns_s {
 	int count;
 	rn_thread_t *thread;
+	rn_spawn_elastic_t *elastic;
 } rn_sched_spawns_t;
 
 int rn_spawn(struct rn_sched_s *sched, int count);
 void rn_spawn_destroy(struct rn_sched_s *sched);
+int rn_spawn_add(struct rn_sched_s *sched);
+int rn_spawn_retire(struct rn_sched_s *sched, int id, uint32_t ms);
+int rn_spawn_elastic(struct rn_sched_s *sched, int min, int max, uint32_t ms);
+int rn_spawn_dispatch(struct rn_sched_s *sched, rn_remote_msg_t *msg);
 struct rn_sched_s *rn_spawn_get(struct rn_sched_s *sched, int id);
+int rn_spawn_affinity(struct rn_sched_s *sched, int id, const cpu_set_t *cpuset);
+int rn_spawn_pin(struct rn_sched_s *sched);
+int rn_spawn_bind(struct rn_sched_s *sched);
+void rn_spawn_mbind(struct rn_sched_s *sched, void *ptr, size_t size);
 int rn_spawn_start(struct rn_sched_s *sched);
 void rn_spawn_stop(struct rn_sched_s *sched);
+void rn_spawn_release(struct rn_sched_s *sched);
+void rn_spawn_drain(struct rn_sched_s *sched, uint32_t ms);
 void rn_spawn_join(struct rn_sched_s *sched);
 
 #endif /* !RINOO_SCHEDULER_SPAWN_H_ */
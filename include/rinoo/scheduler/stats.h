@@ -0,0 +1,65 @@
+/**
+ * @file   stats.h
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Header file for scheduler statistics.
+ *
+ *
+ */
+
+#ifndef RINOO_SCHEDULER_STATS_H_
+#define RINOO_SCHEDULER_STATS_H_
+
+/* Defined in scheduler.h */
+struct rn_sched_s;
+
+/*
+ * Counters are only written by the thread running the scheduler,
+ * with relaxed atomic stores, so that other threads can read them
+ * without locks. Times are in ns on the scheduler clock.
+ * `live` is updated by other schedulers when a task gets stolen.
+ * `poll_time` and `run_time` are only accounted with rn_stats_looptime.
+ */
+typedef struct rn_sched_stats_s {
+	uint64_t switches;
+	uint64_t created;
+	uint64_t destroyed;
+	int64_t live;
+	uint64_t pending;
+	uint64_t runq;
+	uint64_t wakeups;
+	uint64_t events;
+	uint64_t timers;
+	uint64_t yields;
+	uint64_t spins;
+	uint64_t waits;
+	uint64_t poll_time;
+	uint64_t run_time;
+} rn_sched_stats_t;
+
+/*
+ * Histograms are only allocated when enabled. Lag is how late timers
+ * fire compared with their deadline, runtime is the time a task runs
+ * each time it gets resumed. Both are in ns.
+ */
+typedef struct rn_sched_hist_s {
+	rn_histogram_t lag;
+	rn_histogram_t runtime;
+} rn_sched_hist_t;
+
+typedef void (*rn_stats_slow_t)(rn_task_t *task, uint64_t duration);
+
+#define rn_stats_add(sched, field, value)	__atomic_store_n(&(sched)->stats.field, __atomic_load_n(&(sched)->stats.field, __ATOMIC_RELAXED) + (value), __ATOMIC_RELAXED)
+#define rn_stats_inc(sched, field)		rn_stats_add(sched, field, 1)
+
+void rn_stats_get(struct rn_sched_s *sched, rn_sched_stats_t *stats);
+int rn_stats_snapshot(struct rn_sched_s *sched, rn_sched_stats_t *stats, int count);
+int rn_stats_histograms(struct rn_sched_s *sched, bool enabled);
+void rn_stats_cputime(struct rn_sched_s *sched, bool enabled);
+void rn_stats_looptime(struct rn_sched_s *sched, bool enabled);
+void rn_stats_slowtask(struct rn_sched_s *sched, uint64_t threshold, rn_stats_slow_t callback);
+void rn_stats_lag(struct rn_sched_s *sched, uint64_t lag);
+void rn_stats_runtime(rn_task_t *task, uint64_t duration);
+
+#endif /* !RINOO_SCHEDULER_STATS_H_ */
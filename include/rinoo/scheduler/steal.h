@@ -0,0 +1,49 @@
+/**
+ * @file   steal.h
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Header file for work stealing between spawns.
+ *
+ *
+ */
+
+#ifndef RINOO_SCHEDULER_STEAL_H_
+#define RINOO_SCHEDULER_STEAL_H_
+
+/* Defined in scheduler.h */
+struct rn_sched_s;
+
+typedef struct rn_steal_stats_s {
+	uint64_t stolen;
+	uint64_t given;
+	uint64_t failed;
+} rn_steal_stats_t;
+
+/*
+ * Stealable tasks are tasks which have not been started yet.
+ * They are not bound to any file descriptor, so any scheduler of
+ * the same family (a scheduler and its spawns) can run them.
+ * `nbidle`, `nbtasks` and `family` are only used in the family root.
+ */
+typedef struct rn_steal_s {
+	bool enabled;
+	bool idle;
+	uint32_t nbidle;
+	uint32_t nbtasks;
+	rn_list_t tasks;
+	pthread_mutex_t lock;
+	pthread_mutex_t family;
+	rn_steal_stats_t stats;
+} rn_steal_t;
+
+int rn_steal_init(struct rn_sched_s *sched);
+void rn_steal_destroy(struct rn_sched_s *sched);
+int rn_steal_set(struct rn_sched_s *sched, bool enabled);
+void rn_steal_stats(struct rn_sched_s *sched, rn_steal_stats_t *stats);
+void rn_steal_push(struct rn_sched_s *sched, rn_task_t *task);
+int rn_steal_run(struct rn_sched_s *sched);
+bool rn_steal_pending(struct rn_sched_s *sched);
+void rn_steal_idle(struct rn_sched_s *sched, bool idle);
+
+#endif /* !RINOO_SCHEDULER_STEAL_H_ */
@@ -0,0 +1,77 @@
+/**
+ * @file   sync.h
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Header file for task synchronization function declarations.
+ *
+ *
+ */
+
+#ifndef RINOO_SCHEDULER_SYNC_H_
+#define RINOO_SCHEDULER_SYNC_H_
+
+/*
+ * Synchronization primitives suspend tasks, never the scheduler thread.
+ * They can be shared by tasks of any scheduler: a waiting task is
+ * scheduled directly when woken up from its own scheduler, or through
+ * its scheduler remote queue otherwise. The lock only protects the
+ * state and the waiting list, it is never held while a task waits.
+ */
+typedef struct rn_sync_waiter_s {
+	bool woken;
+	bool delivered;
+	rn_task_t *task;
+	rn_list_node_t node;
+	rn_remote_msg_t msg;
+} rn_sync_waiter_t;
+
+typedef struct rn_mutex_s {
+	bool locked;
+	rn_list_t waiters;
+	pthread_mutex_t lock;
+} rn_mutex_t;
+
+typedef struct rn_sem_s {
+	uint32_t value;
+	rn_list_t waiters;
+	pthread_mutex_t lock;
+} rn_sem_t;
+
+typedef struct rn_cond_s {
+	rn_list_t waiters;
+	pthread_mutex_t lock;
+} rn_cond_t;
+
+typedef struct rn_waitgroup_s {
+	int64_t count;
+	rn_list_t waiters;
+	pthread_mutex_t lock;
+} rn_waitgroup_t;
+
+int rn_mutex(rn_mutex_t *mutex);
+void rn_mutex_destroy(rn_mutex_t *mutex);
+int rn_mutex_lock(rn_mutex_t *mutex);
+int rn_mutex_trylock(rn_mutex_t *mutex);
+void rn_mutex_unlock(rn_mutex_t *mutex);
+
+int rn_sem(rn_sem_t *sem, uint32_t value);
+void rn_sem_destroy(rn_sem_t *sem);
+int rn_sem_wait(rn_sem_t *sem);
+int rn_sem_trywait(rn_sem_t *sem);
+void rn_sem_post(rn_sem_t *sem);
+
+int rn_cond(rn_cond_t *cond);
+void rn_cond_destroy(rn_cond_t *cond);
+int rn_cond_wait(rn_cond_t *cond, rn_mutex_t *mutex);
+int rn_cond_timedwait(rn_cond_t *cond, rn_mutex_t *mutex, uint32_t ms);
+void rn_cond_signal(rn_cond_t *cond);
+void rn_cond_broadcast(rn_cond_t *cond);
+
+int rn_waitgroup(rn_waitgroup_t *wg);
+void rn_waitgroup_destroy(rn_waitgroup_t *wg);
+void rn_waitgroup_add(rn_waitgroup_t *wg, int count);
+void rn_waitgroup_done(rn_waitgroup_t *wg);
+int rn_waitgroup_wait(rn_waitgroup_t *wg);
+
+#endif /* !RINOO_SCHEDULER_SYNC_H_ */
@@ -12,27 +12,64 @@
 #define RINOO_SCHEDULER_TASK_H_
 
 #define RN_TASK_STACK_SIZE	(16 * 1024)
+#define RN_TASK_POOL_LOW	0
+#define RN_TASK_POOL_HIGH	256
+/* Timer resolution, in ns */
+#define RN_TASK_TICK		1000000ULL
+/* Timeouts are given in ms, clocks are in ns */
+#define RN_NS_PER_MS		1000000ULL
+#define RN_MS_TO_NS(ms)		((uint64_t) (ms) * RN_NS_PER_MS)
 
 /* Defined in scheduler.h */
 struct rn_sched_s;
 
+/*
+ * Stackless tasks have no stack nor context of their own. Their function
+ * is called on the scheduler main context each time they get resumed,
+ * and must not suspend. Such a task ends once its function returns,
+ * unless it has been scheduled again meanwhile.
+ */
 typedef struct rn_task_s {
 	bool scheduled;
-	struct timeval tv;
+	bool stackless;
+	uint64_t deadline;
+	uint64_t cputime;
+	void *arg;
+	void (*function)(void *arg);
 	struct rn_sched_s *sched;
-	rn_rbtree_node_t proc_node;
+	rn_timer_t timer;
+	rn_list_node_t run_node;
+	rn_list_node_t pool_node;
 	rn_fcontext_t context;
-	char stack[RN_TASK_STACK_SIZE];
 
 #ifdef RINOO_DEBUG
 	int valgrind_stackid;
 #endif /* !RINOO_DEBUG */
 } rn_task_t;
 
+typedef struct rn_task_pool_stats_s {
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t recycled;
+	uint64_t released;
+	uint32_t size;
+} rn_task_pool_stats_t;
+
+typedef struct rn_task_pool_s {
+	uint32_t low;
+	uint32_t high;
+	size_t stack_size;
+	rn_list_t tasks;
+	rn_task_pool_stats_t stats;
+} rn_task_pool_t;
+
 typedef struct rn_task_driver_s {
 	rn_task_t main;
 	rn_task_t *current;
-	rn_rbtree_t proc_tree;
+	rn_list_t runq;
+	rn_wheel_t timers;
+	uint32_t nbtimers;
+	rn_task_pool_t pool;
 } rn_task_driver_t;
 
 int rn_task_driver_init(struct rn_sched_s *sched);
@@ -42,13 +79,23 @@ int rn_task_driver_stop(struct rn_sched_s *sched);
 uint32_t rn_task_driver_nbpending(struct rn_sched_s *sched);
 rn_task_t *rn_task_driver_getcurrent(struct rn_sched_s *sched);
 
+int rn_task_pool_set(struct rn_sched_s *sched, uint32_t low, uint32_t high);
+void rn_task_pool_stats(struct rn_sched_s *sched, rn_task_pool_stats_t *stats);
+int rn_task_stack_set(struct rn_sched_s *sched, size_t size);
+
 rn_task_t *rn_task(struct rn_sched_s *sched, rn_task_t *parent, void (*function)(void *arg), void *arg);
+rn_task_t *rn_task_stackless(struct rn_sched_s *sched, void (*function)(void *arg), void *arg);
 void rn_task_destroy(rn_task_t *task);
 int rn_task_start(struct rn_sched_s *sched, void (*function)(void *arg), void *arg);
 int rn_task_run(struct rn_sched_s *sched, void (*function)(void *arg), void *arg);
+int rn_task_start_stack(struct rn_sched_s *sched, void (*function)(void *arg), void *arg, size_t stack_size);
+int rn_task_start_stealable(struct rn_sched_s *sched, void (*function)(void *arg), void *arg);
+int rn_task_start_stackless(struct rn_sched_s *sched, void (*function)(void *arg), void *arg);
+int rn_task_start_remote(struct rn_sched_s *sched, void (*function)(void *arg), void *arg);
+int rn_task_run_stack(struct rn_sched_s *sched, void (*function)(void *arg), void *arg, size_t stack_size);
 int rn_task_resume(rn_task_t *task);
 int rn_task_release(struct rn_sched_s *sched);
-int rn_task_schedule(rn_task_t *task, struct timeval *tv);
+int rn_task_schedule(rn_task_t *task, uint64_t deadline);
 int rn_task_unschedule(rn_task_t *task);
 int rn_task_start(struct rn_sched_s *sched, void (*function)(void *arg), void *arg);
 int rn_task_wait(struct rn_sched_s *sched, uint32_t ms);
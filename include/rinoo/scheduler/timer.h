@@ -0,0 +1,34 @@
+/**
+ * @file   timer.h
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Header file for callback timer function declarations.
+ *
+ *
+ */
+
+#ifndef RINOO_SCHEDULER_TIMER_H_
+#define RINOO_SCHEDULER_TIMER_H_
+
+/* Defined in scheduler.h */
+struct rn_sched_s;
+
+/*
+ * Timers share the task timing wheel. Tasks embed a timer with no
+ * function, which means the owning task is resumed on expiry.
+ * Callback timers run their function on the scheduler main context.
+ */
+typedef struct rn_timer_s {
+	rn_wheel_node_t node;
+	uint64_t period;
+	bool running;
+	void *arg;
+	void (*function)(void *arg);
+} rn_timer_t;
+
+rn_timer_t *rn_timer_start(struct rn_sched_s *sched, uint32_t ms, bool periodic, void (*function)(void *arg), void *arg);
+void rn_timer_stop(struct rn_sched_s *sched, rn_timer_t *timer);
+void rn_timer_run(struct rn_sched_s *sched, rn_timer_t *timer);
+
+#endif /* !RINOO_SCHEDULER_TIMER_H_ */
@@ -0,0 +1,82 @@
+/**
+ * @file   uring.h
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Header file for io_uring poller function declarations.
+ *
+ *
+ */
+
+#ifndef RINOO_SCHEDULER_URING_H_
+#define RINOO_SCHEDULER_URING_H_
+
+#define RN_URING_ENTRIES	256
+
+struct rn_sched_s;		/* Defined in scheduler.h */
+struct rn_sched_node_s;	/* Defined in scheduler.h */
+enum rn_sched_mode_e;		/* Defined in scheduler.h */
+
+/*
+ * Each registered node owns a slot. Completions carry the slot index
+ * and its generation, so that completions of a removed node are dropped
+ * even if the slot has been reused.
+ */
+typedef struct rn_uring_slot_s {
+	uint32_t gen;
+	uint32_t next;
+	uint32_t events;
+	struct rn_sched_node_s *node;
+} rn_uring_slot_t;
+
+/*
+ * An IO operation submitted by a task. The task is suspended until
+ * the operation completes, operations in flight are listed so that
+ * they can be cancelled when the scheduler stops.
+ */
+typedef struct rn_uring_op_s {
+	int res;
+	bool done;
+	bool cancel;
+	rn_task_t *task;
+	rn_list_node_t node;
+} rn_uring_op_t;
+
+typedef struct rn_uring_s {
+	int fd;
+	void *sq_ring;
+	void *cq_ring;
+	void *sqes;
+	void *cqes;
+	size_t sq_ring_size;
+	size_t cq_ring_size;
+	size_t sqes_size;
+	uint32_t *sq_head;
+	uint32_t *sq_tail;
+	uint32_t *sq_mask;
+	uint32_t *sq_array;
+	uint32_t *cq_head;
+	uint32_t *cq_tail;
+	uint32_t *cq_mask;
+	uint32_t sq_entries;
+	uint32_t nbpending;
+	uint32_t nbslots;
+	uint32_t freeslot;
+	rn_uring_slot_t *slots;
+	rn_list_t ops;
+} rn_uring_t;
+
+#ifdef RINOO_IO_URING
+extern const rn_poller_class_t rn_poller_uring;
+#endif /* !RINOO_IO_URING */
+
+int rn_uring_init(struct rn_sched_s *sched);
+void rn_uring_destroy(struct rn_sched_s *sched);
+int rn_uring_insert(struct rn_sched_node_s *node, enum rn_sched_mode_e mode);
+int rn_uring_addmode(struct rn_sched_node_s *node, enum rn_sched_mode_e mode);
+int rn_uring_remove(struct rn_sched_node_s *node);
+int rn_uring_poll(struct rn_sched_s *sched, int timeout);
+void rn_uring_flush(struct rn_sched_s *sched);
+int rn_uring_io(struct rn_sched_s *sched, uint8_t opcode, int fd, const void *addr, uint32_t len, uint64_t offset, uint32_t flags);
+
+#endif /* !RINOO_SCHEDULER_URING_H_ */
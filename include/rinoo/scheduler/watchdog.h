@@ -0,0 +1,72 @@
+/**
+ * @file   watchdog.h
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Header file for scheduler watchdog function declarations.
+ *
+ *
+ */
+
+#ifndef RINOO_SCHEDULER_WATCHDOG_H_
+#define RINOO_SCHEDULER_WATCHDOG_H_
+
+/*
+ * Signal used to capture the stack of a scheduler thread. The watchdog
+ * installs its own handler for it while running, replacing the one the
+ * application may have. It can be changed at build time.
+ */
+#ifndef RN_WATCHDOG_SIGNAL
+# define RN_WATCHDOG_SIGNAL	SIGURG
+#endif
+#define RN_WATCHDOG_FRAMES	32
+
+/* Defined in scheduler.h */
+struct rn_sched_s;
+
+typedef struct rn_watchdog_report_s {
+	struct rn_sched_s *sched;
+	rn_task_t *task;
+	void (*function)(void *arg);
+	uint64_t duration;
+	int nbframes;
+	void *frames[RN_WATCHDOG_FRAMES];
+} rn_watchdog_report_t;
+
+typedef void (*rn_watchdog_cb_t)(rn_watchdog_report_t *report);
+
+/*
+ * Watchdog state of each scheduler. `thread` is the thread running
+ * the scheduler loop, and `report` is filled by the signal handler
+ * in that thread. `signaling` keeps the thread in its loop while
+ * the watchdog is capturing its stack.
+ */
+typedef struct rn_watchdog_probe_s {
+	bool running;
+	pthread_t thread;
+	rn_task_t *task;
+	uint64_t switches;
+	uint64_t since;
+	bool reported;
+	bool captured;
+	bool signaling;
+	rn_watchdog_report_t report;
+} rn_watchdog_probe_t;
+
+typedef struct rn_watchdog_s {
+	bool stop;
+	uint64_t threshold;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	rn_watchdog_cb_t callback;
+	struct rn_sched_s *sched;
+	struct sigaction previous;
+} rn_watchdog_t;
+
+int rn_watchdog_start(struct rn_sched_s *sched, uint32_t ms, rn_watchdog_cb_t callback);
+void rn_watchdog_stop(struct rn_sched_s *sched);
+void rn_watchdog_enter(struct rn_sched_s *sched);
+void rn_watchdog_leave(struct rn_sched_s *sched);
+
+#endif /* !RINOO_SCHEDULER_WATCHDOG_H_ */
@@ -0,0 +1,36 @@
+/**
+ * @file   histogram.h
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Header file for log-linear histogram.
+ *
+ *
+ */
+
+#ifndef RINOO_STRUCT_HISTOGRAM_H_
+#define RINOO_STRUCT_HISTOGRAM_H_
+
+#define RN_HISTOGRAM_SUBBITS	4
+#define RN_HISTOGRAM_SUB	(1 << RN_HISTOGRAM_SUBBITS)
+#define RN_HISTOGRAM_SIZE	((64 - RN_HISTOGRAM_SUBBITS + 1) * RN_HISTOGRAM_SUB)
+
+/*
+ * Each power of two is split in RN_HISTOGRAM_SUB linear buckets, so that
+ * any value is recorded with a relative error below 1 / RN_HISTOGRAM_SUB,
+ * whatever its magnitude.
+ */
+typedef struct rn_histogram_s {
+	uint64_t count;
+	uint64_t sum;
+	uint64_t min;
+	uint64_t max;
+	uint64_t buckets[RN_HISTOGRAM_SIZE];
+} rn_histogram_t;
+
+void rn_histogram(rn_histogram_t *histogram);
+void rn_histogram_add(rn_histogram_t *histogram, uint64_t value);
+void rn_histogram_merge(rn_histogram_t *dst, const rn_histogram_t *src);
+uint64_t rn_histogram_percentile(const rn_histogram_t *histogram, double percentile);
+
+#endif /* !RINOO_STRUCT_HISTOGRAM_H_ */
@@ -27,6 +27,7 @@ int rn_list(rn_list_t *rn_list, int (*compare)(rn_list_node_t *node1, rn_list_no
 void rn_list_flush(rn_list_t *rn_list, void (*delete)(rn_list_node_t *node1));
 size_t rn_list_size(rn_list_t *rn_list);
 void rn_list_put(rn_list_t *rn_list, rn_list_node_t *node);
+void rn_list_append(rn_list_t *rn_list, rn_list_node_t *node);
 rn_list_node_t *rn_list_get(rn_list_t *rn_list, rn_list_node_t *node);
 int rn_list_remove(rn_list_t *rn_list, rn_list_node_t *node);
 rn_list_node_t *rn_list_pop(rn_list_t *rn_list);
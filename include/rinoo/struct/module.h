@@ -19,5 +19,7 @@
 #include "rinoo/struct/list.h"
 #include "rinoo/struct/vector.h"
 #include "rinoo/struct/htable.h"
+#include "rinoo/struct/wheel.h"
+#include "rinoo/struct/histogram.h"
 
 #endif /* !RINOO_MODULE_STRUCT_H_ */
@@ -0,0 +1,53 @@
+/**
+ * @file   wheel.h
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Header file for hierarchical timing wheel.
+ *
+ *
+ */
+
+#ifndef RINOO_STRUCT_WHEEL_H_
+#define RINOO_STRUCT_WHEEL_H_
+
+#define RN_WHEEL_BITS		6
+#define RN_WHEEL_SLOTS		(1 << RN_WHEEL_BITS)
+#define RN_WHEEL_MASK		(RN_WHEEL_SLOTS - 1)
+#define RN_WHEEL_LEVELS		6
+
+struct rn_wheel_slot_s;
+
+typedef struct rn_wheel_node_s {
+	uint64_t expire;
+	struct rn_wheel_node_s *prev;
+	struct rn_wheel_node_s *next;
+	struct rn_wheel_slot_s *slot;
+} rn_wheel_node_t;
+
+typedef struct rn_wheel_slot_s {
+	rn_wheel_node_t *head;
+	rn_wheel_node_t *tail;
+} rn_wheel_slot_t;
+
+/*
+ * Each level holds RN_WHEEL_SLOTS slots, a slot at level `n` covering
+ * RN_WHEEL_SLOTS^n ticks. Nodes are put in the lowest level able to
+ * hold them and are cascaded down when their slot comes up. `bitmap`
+ * tracks non-empty slots so that the next expiry is found in constant time.
+ */
+typedef struct rn_wheel_s {
+	uint64_t now;
+	uint64_t size;
+	uint64_t bitmap[RN_WHEEL_LEVELS];
+	rn_wheel_slot_t slots[RN_WHEEL_LEVELS][RN_WHEEL_SLOTS];
+} rn_wheel_t;
+
+int rn_wheel(rn_wheel_t *wheel, uint64_t now);
+void rn_wheel_flush(rn_wheel_t *wheel);
+void rn_wheel_put(rn_wheel_t *wheel, rn_wheel_node_t *node, uint64_t expire);
+void rn_wheel_remove(rn_wheel_t *wheel, rn_wheel_node_t *node);
+rn_wheel_node_t *rn_wheel_pop(rn_wheel_t *wheel, uint64_t now);
+uint64_t rn_wheel_next(rn_wheel_t *wheel);
+
+#endif /* !RINOO_STRUCT_WHEEL_H_ */
@@ -116,13 +116,22 @@ entry_error:
 	return NULL;
 }
 
-int rn_fs_browse(const char *path, rn_fs_entry_t **last_entry)
+typedef struct rn_fs_browse_s {
+	const char *path;
+	rn_fs_entry_t **last_entry;
+} rn_fs_browse_t;
+
+static int rn_fs_browse_next(void *arg)
 {
 	DIR *dirfd;
+	const char *path;
+	rn_fs_entry_t **last_entry;
 	rn_fs_entry_t *curentry;
 	struct dirent *result;
 	rn_fs_directory_t *directory;
 
+	path = ((rn_fs_browse_t *) arg)->path;
+	last_entry = ((rn_fs_browse_t *) arg)->last_entry;
 	if (last_entry == NULL) {
 		return -1;
 	}
@@ -198,3 +207,22 @@ browse_error:
 	}
 	return -1;
 }
+
+/**
+ * Browses a directory recursively, one entry per call.
+ * Directory reads block, so they are run on the offload pool
+ * when called from a task.
+ *
+ * @param path Directory to browse
+ * @param last_entry Pointer to the last entry, pointing to NULL on first call and set to NULL at the end
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_fs_browse(const char *path, rn_fs_entry_t **last_entry)
+{
+	rn_fs_browse_t browse;
+
+	browse.path = path;
+	browse.last_entry = last_entry;
+	return rn_task_offload(rn_scheduler_self(), rn_fs_browse_next, &browse);
+}
@@ -0,0 +1,348 @@
+/**
+ * @file   file.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Asynchronous file functions
+ *
+ *
+ */
+
+#include "rinoo/fs/module.h"
+
+#ifdef RINOO_IO_URING
+#include <linux/io_uring.h>
+#endif /* !RINOO_IO_URING */
+
+typedef enum rn_file_optype_e {
+	RN_FILE_OPEN = 0,
+	RN_FILE_CLOSE,
+	RN_FILE_READ,
+	RN_FILE_WRITE,
+	RN_FILE_FSYNC,
+	RN_FILE_STAT,
+} rn_file_optype_t;
+
+typedef struct rn_file_op_s {
+	rn_file_optype_t type;
+	int fd;
+	int flags;
+	mode_t mode;
+	const char *path;
+	void *buf;
+	size_t count;
+	off_t offset;
+	ssize_t ret;
+} rn_file_op_t;
+
+/**
+ * Runs a file operation with blocking calls.
+ * This function is run on the offload pool.
+ *
+ * @param arg Pointer to the operation
+ *
+ * @return 0 on success, otherwise -1 and errno is set
+ */
+static int rn_file_blocking(void *arg)
+{
+	rn_file_op_t *op = arg;
+
+	switch (op->type) {
+	case RN_FILE_OPEN:
+		op->ret = open(op->path, op->flags, op->mode);
+		break;
+	case RN_FILE_CLOSE:
+		op->ret = close(op->fd);
+		break;
+	case RN_FILE_READ:
+		op->ret = pread(op->fd, op->buf, op->count, op->offset);
+		break;
+	case RN_FILE_WRITE:
+		op->ret = pwrite(op->fd, op->buf, op->count, op->offset);
+		break;
+	case RN_FILE_FSYNC:
+		op->ret = fsync(op->fd);
+		break;
+	case RN_FILE_STAT:
+		op->ret = fstat(op->fd, op->buf);
+		break;
+	}
+	return (op->ret < 0 ? -1 : 0);
+}
+
+/**
+ * Runs a file operation. The current task is suspended until it completes.
+ * A file can be used from any scheduler, the operation always goes
+ * through the scheduler running the current task.
+ *
+ * @param sched Pointer to the scheduler to use outside of a task, or NULL
+ * @param op Pointer to the operation
+ *
+ * @return Operation result, or -1 if an error occurs
+ */
+static ssize_t rn_file_op(rn_sched_t *sched, rn_file_op_t *op)
+{
+	rn_sched_t *self;
+#ifdef RINOO_IO_URING
+	static const uint8_t opcodes[] = {
+		[RN_FILE_OPEN] = IORING_OP_OPENAT,
+		[RN_FILE_CLOSE] = IORING_OP_CLOSE,
+		[RN_FILE_READ] = IORING_OP_READ,
+		[RN_FILE_WRITE] = IORING_OP_WRITE,
+		[RN_FILE_FSYNC] = IORING_OP_FSYNC,
+	};
+#endif /* !RINOO_IO_URING */
+
+	self = rn_scheduler_self();
+	if (self != NULL) {
+		sched = self;
+	}
+#ifdef RINOO_IO_URING
+	if (sched != NULL && sched->poller == &rn_poller_uring && op->type != RN_FILE_STAT && rn_task_driver_getcurrent(sched) != &sched->driver.main) {
+		switch (op->type) {
+		case RN_FILE_OPEN:
+			return rn_uring_io(sched, opcodes[op->type], AT_FDCWD, op->path, op->mode, 0, op->flags);
+		case RN_FILE_READ:
+		case RN_FILE_WRITE:
+			return rn_uring_io(sched, opcodes[op->type], op->fd, op->buf, op->count, op->offset, 0);
+		default:
+			return rn_uring_io(sched, opcodes[op->type], op->fd, NULL, 0, 0, 0);
+		}
+	}
+#endif /* !RINOO_IO_URING */
+	if (rn_task_offload(sched, rn_file_blocking, op) != 0) {
+		rn_error_set(errno);
+		return -1;
+	}
+	return op->ret;
+}
+
+/**
+ * Opens a file.
+ *
+ * @param sched Pointer to the scheduler running the current task
+ * @param path File path
+ * @param flags Open flags, as in open(2)
+ * @param mode Mode of a created file
+ *
+ * @return Pointer to the new file, or NULL if an error occurs
+ */
+rn_file_t *rn_file_open(rn_sched_t *sched, const char *path, int flags, mode_t mode)
+{
+	rn_file_t *file;
+	rn_file_op_t op = { .type = RN_FILE_OPEN, .path = path, .flags = flags, .mode = mode };
+
+	XASSERT(sched != NULL, NULL);
+	XASSERT(path != NULL, NULL);
+
+	file = calloc(1, sizeof(*file));
+	if (file == NULL) {
+		return NULL;
+	}
+	file->fd = rn_file_op(sched, &op);
+	if (file->fd < 0) {
+		free(file);
+		return NULL;
+	}
+	return file;
+}
+
+/**
+ * Closes a file and releases it.
+ *
+ * @param file Pointer to the file to close
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_file_close(rn_file_t *file)
+{
+	int ret;
+	rn_file_op_t op = { .type = RN_FILE_CLOSE };
+
+	XASSERT(file != NULL, -1);
+
+	op.fd = file->fd;
+	ret = rn_file_op(NULL, &op);
+	free(file);
+	return (ret < 0 ? -1 : 0);
+}
+
+/**
+ * Gets file status.
+ *
+ * @param file Pointer to the file to use
+ * @param stats Pointer to the status to fill
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_file_stat(rn_file_t *file, struct stat *stats)
+{
+	rn_file_op_t op = { .type = RN_FILE_STAT };
+
+	XASSERT(file != NULL, -1);
+	XASSERT(stats != NULL, -1);
+
+	op.fd = file->fd;
+	op.buf = stats;
+	return (rn_file_op(NULL, &op) < 0 ? -1 : 0);
+}
+
+/**
+ * Reads from a file at a given offset.
+ *
+ * @param file Pointer to the file to read
+ * @param buf Pointer to the destination buffer
+ * @param count Maximum number of bytes to read
+ * @param offset File offset
+ *
+ * @return Number of bytes read, 0 at the end of the file, or -1 if an error occurs
+ */
+ssize_t rn_file_pread(rn_file_t *file, void *buf, size_t count, off_t offset)
+{
+	rn_file_op_t op = { .type = RN_FILE_READ };
+
+	XASSERT(file != NULL, -1);
+	XASSERT(buf != NULL, -1);
+
+	op.fd = file->fd;
+	op.buf = buf;
+	op.count = (count > RN_FILE_IO_MAX ? RN_FILE_IO_MAX : count);
+	op.offset = offset;
+	return rn_file_op(NULL, &op);
+}
+
+/**
+ * Writes to a file at a given offset.
+ * Files opened with O_APPEND are always written at the end.
+ *
+ * @param file Pointer to the file to write
+ * @param buf Pointer to the data to write
+ * @param count Number of bytes to write
+ * @param offset File offset
+ *
+ * @return Number of bytes written, or -1 if an error occurs
+ */
+ssize_t rn_file_pwrite(rn_file_t *file, const void *buf, size_t count, off_t offset)
+{
+	rn_file_op_t op = { .type = RN_FILE_WRITE };
+
+	XASSERT(file != NULL, -1);
+	XASSERT(buf != NULL, -1);
+
+	op.fd = file->fd;
+	op.buf = (void *) buf;
+	op.count = (count > RN_FILE_IO_MAX ? RN_FILE_IO_MAX : count);
+	op.offset = offset;
+	return rn_file_op(NULL, &op);
+}
+
+/**
+ * Reads from a file at its current offset, and moves the offset forward.
+ *
+ * @param file Pointer to the file to read
+ * @param buf Pointer to the destination buffer
+ * @param count Maximum number of bytes to read
+ *
+ * @return Number of bytes read, 0 at the end of the file, or -1 if an error occurs
+ */
+ssize_t rn_file_read(rn_file_t *file, void *buf, size_t count)
+{
+	ssize_t ret;
+
+	XASSERT(file != NULL, -1);
+
+	ret = rn_file_pread(file, buf, count, file->offset);
+	if (ret > 0) {
+		file->offset += ret;
+	}
+	return ret;
+}
+
+/**
+ * Writes to a file at its current offset, and moves the offset forward.
+ *
+ * @param file Pointer to the file to write
+ * @param buf Pointer to the data to write
+ * @param count Number of bytes to write
+ *
+ * @return Number of bytes written, or -1 if an error occurs
+ */
+ssize_t rn_file_write(rn_file_t *file, const void *buf, size_t count)
+{
+	ssize_t ret;
+
+	XASSERT(file != NULL, -1);
+
+	ret = rn_file_pwrite(file, buf, count, file->offset);
+	if (ret > 0) {
+		file->offset += ret;
+	}
+	return ret;
+}
+
+/**
+ * Flushes file data and metadata to disk.
+ *
+ * @param file Pointer to the file to flush
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_file_fsync(rn_file_t *file)
+{
+	rn_file_op_t op = { .type = RN_FILE_FSYNC };
+
+	XASSERT(file != NULL, -1);
+
+	op.fd = file->fd;
+	return (rn_file_op(NULL, &op) < 0 ? -1 : 0);
+}
+
+/**
+ * File read interface for rn_buffer_t.
+ * Reads once into the buffer free space. The buffer is extended if it is full.
+ *
+ * @param file Pointer to the file to read
+ * @param buffer Pointer to the buffer where to store data read
+ *
+ * @return Number of bytes read, 0 at the end of the file, or -1 if an error occurs
+ */
+ssize_t rn_file_readb(rn_file_t *file, rn_buffer_t *buffer)
+{
+	ssize_t res;
+
+	XASSERT(buffer != NULL, -1);
+
+	if (rn_buffer_isfull(buffer) && rn_buffer_extend(buffer, rn_buffer_size(buffer)) != 0) {
+		return -1;
+	}
+	res = rn_file_read(file, rn_buffer_ptr(buffer) + rn_buffer_size(buffer), rn_buffer_msize(buffer) - rn_buffer_size(buffer));
+	if (res > 0) {
+		rn_buffer_setsize(buffer, rn_buffer_size(buffer) + res);
+	}
+	return res;
+}
+
+/**
+ * File write interface for rn_buffer_t.
+ * Writes the whole buffer content.
+ *
+ * @param file Pointer to the file to write
+ * @param buffer Pointer to the buffer to write
+ *
+ * @return Number of bytes written, or -1 if an error occurs
+ */
+ssize_t rn_file_writeb(rn_file_t *file, rn_buffer_t *buffer)
+{
+	size_t sent;
+	ssize_t res;
+
+	XASSERT(buffer != NULL, -1);
+
+	for (sent = 0; sent < rn_buffer_size(buffer); sent += res) {
+		res = rn_file_write(file, rn_buffer_ptr(buffer) + sent, rn_buffer_size(buffer) - sent);
+		if (res <= 0) {
+			return -1;
+		}
+	}
+	return sent;
+}
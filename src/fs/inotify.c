@@ -114,6 +114,7 @@ static int rn_inotify_waitio(rn_inotify_t *inotify)
 	inotify->io_calls++;
 	if (inotify->io_calls > 10) {
 		inotify->io_calls = 0;
+		rn_stats_inc(inotify->node.sched, yields);
 		if (rn_task_pause(inotify->node.sched) != 0) {
 				return -1;
 		}
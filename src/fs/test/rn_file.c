@@ -0,0 +1,111 @@
+/**
+ * @file   rn_file.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Asynchronous file unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define TEST_STRING	"The quick brown fox jumps over the lazy dog"
+
+char path[] = "/tmp/rn_file_XXXXXX";
+int fds[2];
+int cancelled = 0;
+
+void file_task(void *sched)
+{
+	char tmp[8];
+	rn_file_t *file;
+	rn_buffer_t *buffer;
+	struct stat stats;
+
+	XTEST(rn_file_open(sched, "/nonexistent/rn_file", O_RDONLY, 0) == NULL);
+	XTEST(rn_error == ENOENT);
+	file = rn_file_open(sched, path, O_RDWR | O_TRUNC, 0600);
+	XTEST(file != NULL);
+	buffer = rn_buffer_create(NULL);
+	XTEST(buffer != NULL);
+	XTEST(rn_buffer_addstr(buffer, TEST_STRING) == (int) strlen(TEST_STRING));
+	XTEST(rn_file_writeb(file, buffer) == (ssize_t) strlen(TEST_STRING));
+	XTEST(rn_file_fsync(file) == 0);
+	XTEST(rn_file_stat(file, &stats) == 0);
+	XTEST(stats.st_size == (off_t) strlen(TEST_STRING));
+	XTEST(rn_file_pread(file, tmp, 5, 4) == 5);
+	XTEST(memcmp(tmp, "quick", 5) == 0);
+	XTEST(rn_file_pwrite(file, "QUICK", 5, 4) == 5);
+	XTEST(rn_file_close(file) == 0);
+	file = rn_file_open(sched, path, O_RDONLY, 0);
+	XTEST(file != NULL);
+	rn_buffer_erase(buffer, rn_buffer_size(buffer));
+	while (rn_file_readb(file, buffer) > 0);
+	XTEST(rn_buffer_size(buffer) == strlen(TEST_STRING));
+	XTEST(memcmp(rn_buffer_ptr(buffer), "The QUICK brown fox", 19) == 0);
+	XTEST(rn_file_read(file, tmp, sizeof(tmp)) == 0);
+	XTEST(rn_file_close(file) == 0);
+	rn_buffer_destroy(buffer);
+}
+
+void pipe_task(void *unused(arg))
+{
+	char tmp[8];
+	rn_file_t file = { .fd = fds[0] };
+
+	/* Nothing is ever written, the read completes once cancelled */
+	XTEST(rn_file_read(&file, tmp, sizeof(tmp)) == -1);
+	XTEST(rn_error == ECANCELED);
+	cancelled++;
+}
+
+void stop_task(void *sched)
+{
+	rn_scheduler_stop(sched);
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	int fd;
+	rn_sched_t *sched;
+
+	fd = mkstemp(path);
+	XTEST(fd >= 0);
+	close(fd);
+	/* Offload pool */
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(rn_task_start(sched, file_task, sched) == 0);
+	rn_scheduler_loop(sched);
+	rn_scheduler_destroy(sched);
+#ifdef RINOO_IO_URING
+	/* io_uring */
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(rn_scheduler_poller_set(sched, &rn_poller_uring) == 0);
+	XTEST(rn_task_start(sched, file_task, sched) == 0);
+	rn_scheduler_loop(sched);
+	rn_scheduler_destroy(sched);
+	/* Stopping with a read in flight */
+	XTEST(pipe(fds) == 0);
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(rn_scheduler_poller_set(sched, &rn_poller_uring) == 0);
+	XTEST(rn_task_start(sched, pipe_task, sched) == 0);
+	XTEST(rn_task_start(sched, stop_task, sched) == 0);
+	rn_scheduler_loop(sched);
+	rn_scheduler_destroy(sched);
+	XTEST(cancelled == 1);
+	close(fds[0]);
+	close(fds[1]);
+#endif /* !RINOO_IO_URING */
+	unlink(path);
+	XPASS();
+}
@@ -123,6 +123,37 @@ rn_socket_t *rn_socket_dup(rn_sched_t *destination, rn_socket_t *socket)
 	return new;
 }
 
+/**
+ * Moves a socket to another scheduler.
+ * Unlike rn_socket_dup, the file descriptor and the socket structure are kept.
+ * The socket is removed from its current scheduler and will be registered
+ * in the destination scheduler on its next wait. This must be called either
+ * from the thread running the current socket scheduler, or while the socket
+ * is not registered, typically from a task which just got stolen.
+ *
+ * @param destination Pointer to a scheduler
+ * @param socket Socket to migrate
+ *
+ * @return 0 on success or -1 if an error occurs
+ */
+int rn_socket_migrate(rn_sched_t *destination, rn_socket_t *socket)
+{
+	XASSERT(destination != NULL, -1);
+	XASSERT(socket != NULL, -1);
+	XASSERT(socket->node.task == NULL, -1);
+
+	if (socket->node.sched == destination) {
+		return 0;
+	}
+	if (rn_mode_registered_get(&socket->node) != RN_MODE_NONE) {
+		rn_scheduler_remove(&socket->node);
+	}
+	socket->node.modes = 0;
+	socket->node.error = 0;
+	socket->node.sched = destination;
+	return 0;
+}
+
 /**
  * Close a socket only (does not free memory).
  *
@@ -189,6 +220,7 @@ int rn_socket_waitio(rn_socket_t *socket)
 	socket->io_calls++;
 	if (socket->io_calls > MAX_IO_CALLS) {
 		socket->io_calls = 0;
+		rn_stats_inc(socket->node.sched, yields);
 		if (rn_task_pause(socket->node.sched) != 0) {
 			return -1;
 		}
@@ -206,18 +238,44 @@ int rn_socket_waitio(rn_socket_t *socket)
  */
 int rn_socket_timeout(rn_socket_t *socket, uint32_t ms)
 {
-	struct timeval res;
-	struct timeval toadd;
+	uint64_t deadline;
+
+	XASSERT(socket != NULL, -1);
+
+	deadline = 0;
+	if (ms > 0) {
+		deadline = socket->node.sched->clock + RN_MS_TO_NS(ms);
+	}
+	return rn_task_schedule(rn_task_driver_getcurrent(socket->node.sched), deadline);
+}
+
+/**
+ * Enables busy polling of the device queue when a socket has no data.
+ * It sets SO_BUSY_POLL and, when available, SO_PREFER_BUSY_POLL.
+ * Raising the value above net.core.busy_read requires CAP_NET_ADMIN.
+ *
+ * @param socket Socket pointer
+ * @param us Busy poll time in microseconds, 0 to disable
+ *
+ * @return 0 on success or -1 if an error occurs
+ */
+int rn_socket_busypoll(rn_socket_t *socket, uint32_t us)
+{
+	int value;
 
 	XASSERT(socket != NULL, -1);
 
-	if (ms == 0) {
-		return rn_task_schedule(rn_task_driver_getcurrent(socket->node.sched), NULL);
+	value = (int) us;
+	if (setsockopt(socket->node.fd, SOL_SOCKET, SO_BUSY_POLL, &value, sizeof(value)) != 0) {
+		return -1;
+	}
+#ifdef SO_PREFER_BUSY_POLL
+	value = (us > 0);
+	if (setsockopt(socket->node.fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &value, sizeof(value)) != 0) {
+		return -1;
 	}
-	toadd.tv_sec = ms / 1000;
-	toadd.tv_usec = (ms % 1000) * 1000;
-	timeradd(&socket->node.sched->clock, &toadd, &res);
-	return rn_task_schedule(rn_task_driver_getcurrent(socket->node.sched), &res);
+#endif /* !SO_PREFER_BUSY_POLL */
+	return 0;
 }
 
 /**
@@ -250,7 +308,12 @@ int rn_socket_bind(rn_socket_t *socket, const rn_addr_t *dst, int backlog)
 	XASSERT(socket != NULL, -1);
 	XASSERT(socket->class->bind != NULL, -1);
 
-	return socket->class->bind(socket, dst, backlog);
+	if (socket->class->bind(socket, dst, backlog) != 0) {
+		return -1;
+	}
+	/* Accepting tasks are cancelled when the scheduler drains */
+	socket->node.listening = (socket->class->accept != NULL);
+	return 0;
 }
 
 /**
@@ -266,6 +329,10 @@ rn_socket_t *rn_socket_accept(rn_socket_t *socket, rn_addr_t *from)
 	XASSERT(socket != NULL, NULL);
 	XASSERT(socket->class->accept != NULL, NULL);
 
+	if (__atomic_load_n(&socket->node.sched->draining, __ATOMIC_RELAXED)) {
+		rn_error_set(ECANCELED);
+		return NULL;
+	}
 	return socket->class->accept(socket, from);
 }
 
@@ -10,6 +10,10 @@
 
 #include "rinoo/net/module.h"
 
+#ifdef RINOO_IO_URING
+#include <linux/io_uring.h>
+#endif /* !RINOO_IO_URING */
+
 const rn_socket_class_t socket_class_tcp = {
 	.domain = AF_INET,
 	.type = SOCK_STREAM,
@@ -144,6 +148,101 @@ int rn_socket_class_tcp_close(rn_socket_t *socket)
 	return close(socket->node.fd);
 }
 
+#ifdef RINOO_IO_URING
+/**
+ * Runs a socket operation through io_uring, if the socket scheduler
+ * uses the io_uring poller. The calling task is suspended until the
+ * operation completes, instead of waiting for readiness first.
+ *
+ * @param socket Socket pointer
+ * @param opcode io_uring operation
+ * @param buf Operation buffer
+ * @param count Buffer size
+ * @param offset Operation offset (address length for accept)
+ * @param flags Operation flags
+ * @param ret Pointer where to store the operation result, errno is set on error
+ *
+ * @return true if the operation went through io_uring, otherwise false
+ */
+static bool rn_socket_class_tcp_uring(rn_socket_t *socket, uint8_t opcode, const void *buf, size_t count, uint64_t offset, uint32_t flags, ssize_t *ret)
+{
+	rn_sched_t *sched;
+
+	sched = socket->node.sched;
+	if (sched->poller != &rn_poller_uring || rn_task_driver_getcurrent(sched) == &sched->driver.main) {
+		return false;
+	}
+	*ret = rn_uring_io(sched, opcode, socket->node.fd, buf, (count > INT_MAX ? INT_MAX : count), offset, flags);
+	if (*ret < 0) {
+		errno = rn_error;
+	}
+	return true;
+}
+#endif /* !RINOO_IO_URING */
+
+/**
+ * Receives data, through io_uring when available, otherwise with read(2).
+ *
+ * @param socket Socket pointer
+ * @param buf Buffer where to store data
+ * @param count Buffer size
+ *
+ * @return Number of bytes read, or -1 and errno is set
+ */
+static ssize_t rn_socket_class_tcp_recv(rn_socket_t *socket, void *buf, size_t count)
+{
+#ifdef RINOO_IO_URING
+	ssize_t ret;
+
+	if (rn_socket_class_tcp_uring(socket, IORING_OP_RECV, buf, count, 0, 0, &ret)) {
+		return ret;
+	}
+#endif /* !RINOO_IO_URING */
+	return read(socket->node.fd, buf, count);
+}
+
+/**
+ * Sends data, through io_uring when available, otherwise with write(2).
+ *
+ * @param socket Socket pointer
+ * @param buf Data to send
+ * @param count Data size
+ *
+ * @return Number of bytes written, or -1 and errno is set
+ */
+static ssize_t rn_socket_class_tcp_send(rn_socket_t *socket, const void *buf, size_t count)
+{
+#ifdef RINOO_IO_URING
+	ssize_t ret;
+
+	if (rn_socket_class_tcp_uring(socket, IORING_OP_SEND, buf, count, 0, 0, &ret)) {
+		return ret;
+	}
+#endif /* !RINOO_IO_URING */
+	return write(socket->node.fd, buf, count);
+}
+
+/**
+ * Accepts a connection, through io_uring when available, otherwise with accept4(2).
+ *
+ * @param socket Listening socket pointer
+ * @param from Address to peer socket
+ * @param addr_len Pointer to the address length
+ *
+ * @return The new file descriptor, or -1 and errno is set
+ */
+static int rn_socket_class_tcp_accept4(rn_socket_t *socket, rn_addr_t *from, socklen_t *addr_len)
+{
+#ifdef RINOO_IO_URING
+	ssize_t ret;
+
+	if (rn_socket_class_tcp_uring(socket, IORING_OP_ACCEPT, &from->sa, 0, (uint64_t)(uintptr_t) addr_len, SOCK_NONBLOCK, &ret)) {
+		return ret;
+	}
+#endif /* !RINOO_IO_URING */
+	return accept4(socket->node.fd, &from->sa, addr_len, SOCK_NONBLOCK);
+}
+
 /**
  * Replacement to the read(2) syscall in this library.
  * This function waits for the socket to be available for read operations and calls the read(2) syscall.
@@ -161,7 +260,7 @@ ssize_t rn_socket_class_tcp_read(rn_socket_t *socket, void *buf, size_t count)
 	if (rn_socket_waitio(socket) != 0) {
 		return -1;
 	}
-	while ((ret = read(socket->node.fd, buf, count)) < 0) {
+	while ((ret = rn_socket_class_tcp_recv(socket, buf, count)) < 0) {
 		if (errno != EAGAIN && errno != EWOULDBLOCK) {
 			rn_error_set(errno);
 			return -1;
@@ -234,7 +333,7 @@ ssize_t	rn_socket_class_tcp_write(rn_socket_t *socket, const void *buf, size_t c
 		if (rn_socket_waitio(socket) != 0) {
 			return -1;
 		}
-		ret = write(socket->node.fd, buf, count);
+		ret = rn_socket_class_tcp_send(socket, buf, count);
 		if (ret == 0) {
 			//FIXME: set rn_error
 			return -1;
@@ -477,7 +576,7 @@ rn_socket_t *rn_socket_class_tcp_accept(rn_socket_t *socket, rn_addr_t *from)
 		return NULL;
 	}
 	addr_len = sizeof(*from);
-	while ((fd = accept4(socket->node.fd, &from->sa, &addr_len, SOCK_NONBLOCK)) < 0) {
+	while ((fd = rn_socket_class_tcp_accept4(socket, from, &addr_len)) < 0) {
 		switch (errno) {
 			case EAGAIN:
 			case ENETDOWN:
@@ -63,3 +63,104 @@ rn_socket_t *rn_tcp_server(rn_sched_t *sched, rn_addr_t *dst)
 	}
 	return socket;
 }
+
+typedef struct rn_tcp_dispatch_s {
+	rn_socket_t *server;
+	void (*function)(void *socket);
+} rn_tcp_dispatch_t;
+
+typedef struct rn_tcp_dispatch_msg_s {
+	rn_remote_msg_t msg;
+	rn_socket_t *socket;
+	void (*function)(void *socket);
+} rn_tcp_dispatch_msg_t;
+
+/**
+ * Remote handler starting a dispatched connection task.
+ * The accepted socket is not registered yet, so it can be migrated
+ * from the destination thread.
+ *
+ * @param sched Pointer to the scheduler handling the message
+ * @param msg Pointer to the remote message
+ */
+static void rn_tcp_dispatch_start(rn_sched_t *sched, rn_remote_msg_t *msg)
+{
+	rn_tcp_dispatch_msg_t *dmsg;
+
+	dmsg = container_of(msg, rn_tcp_dispatch_msg_t, msg);
+	if (rn_socket_migrate(sched, dmsg->socket) != 0 || rn_task_start(sched, dmsg->function, dmsg->socket) != 0) {
+		rn_socket_destroy(dmsg->socket);
+	}
+	__atomic_sub_fetch(&sched->inflight, 1, __ATOMIC_RELAXED);
+	free(dmsg);
+}
+
+/**
+ * Acceptor task hand over each connection to the least loaded spawn.
+ *
+ * @param arg Pointer to the dispatcher context
+ */
+static void rn_tcp_dispatch_process(void *arg)
+{
+	rn_socket_t *client;
+	rn_tcp_dispatch_t *dispatch = arg;
+	rn_tcp_dispatch_msg_t *dmsg;
+
+	while ((client = rn_socket_accept(dispatch->server, NULL)) != NULL) {
+		dmsg = malloc(sizeof(*dmsg));
+		if (unlikely(dmsg == NULL)) {
+			rn_socket_destroy(client);
+			continue;
+		}
+		dmsg->msg.handler = rn_tcp_dispatch_start;
+		dmsg->socket = client;
+		dmsg->function = dispatch->function;
+		if (rn_spawn_dispatch(dispatch->server->node.sched, &dmsg->msg) != 0) {
+			rn_socket_destroy(client);
+			free(dmsg);
+		}
+	}
+	rn_socket_destroy(dispatch->server);
+	free(dispatch);
+}
+
+/**
+ * Creates a TCP server with a single acceptor task, which hands
+ * over each accepted connection to the least loaded spawn.
+ * Accepted sockets are moved to their spawn as is, no file descriptor
+ * nor socket structure gets duplicated. The function is started as a
+ * task on the chosen spawn with the accepted socket as argument, and
+ * is responsible for destroying it.
+ *
+ * @param sched Scheduler pointer running the acceptor task
+ * @param dst Address to bind
+ * @param function Connection task function
+ *
+ * @return 0 on success or -1 if an error occurs
+ */
+int rn_tcp_dispatch(rn_sched_t *sched, rn_addr_t *dst, void (*function)(void *socket))
+{
+	rn_tcp_dispatch_t *dispatch;
+
+	XASSERT(sched != NULL, -1);
+	XASSERT(dst != NULL, -1);
+	XASSERT(function != NULL, -1);
+
+	dispatch = malloc(sizeof(*dispatch));
+	if (unlikely(dispatch == NULL)) {
+		rn_error_set(ENOMEM);
+		return -1;
+	}
+	dispatch->function = function;
+	dispatch->server = rn_tcp_server(sched, dst);
+	if (dispatch->server == NULL) {
+		free(dispatch);
+		return -1;
+	}
+	if (rn_task_start(sched, rn_tcp_dispatch_process, dispatch) != 0) {
+		rn_socket_destroy(dispatch->server);
+		free(dispatch);
+		return -1;
+	}
+	return 0;
+}
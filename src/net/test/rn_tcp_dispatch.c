@@ -0,0 +1,103 @@
+/**
+ * @file   rn_tcp_dispatch.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Test file for least loaded connection dispatch.
+ *
+ *
+ */
+#include "rinoo/rinoo.h"
+
+#define NBSPAWNS	3
+#define NBCLIENTS	30
+
+rn_socket_t *clients[NBCLIENTS];
+char owners[NBCLIENTS];
+
+void process_client(void *arg)
+{
+	char b;
+	char id;
+	rn_socket_t *socket = arg;
+
+	XTEST(socket->node.sched == rn_scheduler_self());
+	XTEST(rn_socket_read(socket, &b, 1) == 1);
+	id = socket->node.sched->id;
+	XTEST(rn_socket_write(socket, &id, 1) == 1);
+	while (rn_socket_read(socket, &b, 1) > 0);
+	rn_socket_destroy(socket);
+}
+
+int connect_client(rn_sched_t *sched, int i)
+{
+	rn_addr_t addr;
+
+	rn_addr4(&addr, "127.0.0.1", 4247);
+	clients[i] = rn_tcp_client(sched, &addr, 0);
+	XTEST(clients[i] != NULL);
+	XTEST(rn_socket_write(clients[i], "x", 1) == 1);
+	XTEST(rn_socket_read(clients[i], &owners[i], 1) == 1);
+	return owners[i];
+}
+
+void controller(void *arg)
+{
+	int i;
+	int count[NBSPAWNS + 1] = { 0 };
+	rn_sched_t *sched = arg;
+	rn_sched_t *spawn;
+
+	for (i = 0; i < NBCLIENTS; i++) {
+		count[connect_client(sched, i)]++;
+	}
+	XTEST(count[0] == 0);
+	for (i = 1; i <= NBSPAWNS; i++) {
+		rn_log("spawn %d - %d connections", i, count[i]);
+		XTEST(count[i] == NBCLIENTS / NBSPAWNS);
+	}
+	/* Unload spawn 1, new connections must all land there */
+	for (i = 0; i < NBCLIENTS; i++) {
+		if (owners[i] == 1) {
+			rn_socket_destroy(clients[i]);
+			clients[i] = NULL;
+		}
+	}
+	spawn = rn_spawn_get(sched, 1);
+	for (i = 0; i < 1000 && __atomic_load_n(&spawn->stats.live, __ATOMIC_RELAXED) > 0; i++) {
+		rn_task_wait(sched, 1);
+	}
+	for (i = 0; i < NBCLIENTS; i++) {
+		if (clients[i] == NULL) {
+			XTEST(connect_client(sched, i) == 1);
+		}
+	}
+	for (i = 0; i < NBCLIENTS; i++) {
+		rn_socket_destroy(clients[i]);
+	}
+	rn_scheduler_stop(sched);
+}
+
+/**
+ * Main function for this unit test.
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	int i;
+	rn_addr_t addr;
+	rn_sched_t *sched;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	for (i = 1; i <= NBSPAWNS; i++) {
+		XTEST(rn_spawn_add(sched) == i);
+	}
+	rn_addr4(&addr, "127.0.0.1", 4247);
+	XTEST(rn_tcp_dispatch(sched, &addr, process_client) == 0);
+	XTEST(rn_task_start(sched, controller, sched) == 0);
+	rn_scheduler_loop(sched);
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
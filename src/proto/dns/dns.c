@@ -10,10 +10,31 @@
 
 #include "rinoo/proto/dns/module.h"
 
+/**
+ * Reads the resolver configuration and gets the first name server.
+ * This function blocks and is run on the offload pool. The resolver
+ * state is per thread, so the address is copied.
+ *
+ * @param arg Pointer to the address to fill
+ *
+ * @return 0 on success, otherwise -1
+ */
+static int rn_dns_nameserver(void *arg)
+{
+	if (res_init() != 0) {
+		return -1;
+	}
+	memcpy(arg, &_res.nsaddr_list[0], sizeof(_res.nsaddr_list[0]));
+	return 0;
+}
+
 void rn_dns_init(rn_sched_t *sched, rn_dns_t *dns, rn_dns_type_t type, const char *host)
 {
-	res_init();
-	dns->socket = rn_udp_client(sched, (rn_addr_t *) &(_res.nsaddr_list[0]));
+	struct sockaddr_in nameserver;
+
+	memset(&nameserver, 0, sizeof(nameserver));
+	rn_task_offload(sched, rn_dns_nameserver, &nameserver);
+	dns->socket = rn_udp_client(sched, (rn_addr_t *) &nameserver);
 	dns->host = host;
 	dns->answer = NULL;
 	dns->authority = NULL;
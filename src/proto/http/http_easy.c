@@ -61,20 +61,77 @@ static void rn_http_easy_route_call(rn_http_t *http, rn_http_route_t *route)
 	}
 }
 
+static void rn_http_easy_client_process(void *context);
+
+/**
+ * Waits for the next request on a keep-alive connection.
+ *
+ * @param socket Pointer to the client socket
+ *
+ * @return 1 if data is available, 0 if the connection stayed idle for RN_HTTP_EASY_IDLE ms, or -1 if an error occurs
+ */
+static int rn_http_easy_client_idle(rn_socket_t *socket)
+{
+	int ret;
+	char byte;
+
+	ret = recv(socket->node.fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+	if (ret > 0) {
+		return 1;
+	}
+	if (ret == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+		return -1;
+	}
+	/* Nothing to read, a latched event is stale */
+	rn_mode_received_unset(&socket->node, RN_MODE_IN);
+	if (rn_socket_timeout(socket, RN_HTTP_EASY_IDLE) != 0) {
+		return -1;
+	}
+	ret = rn_socket_waitin(socket);
+	rn_task_unschedule(rn_task_driver_getcurrent(socket->node.sched));
+	if (ret == 0) {
+		return 1;
+	}
+	return (rn_error == ETIMEDOUT ? 0 : -1);
+}
+
+/**
+ * Restarts the processing of a parked connection once it is readable.
+ * This is run by a stackless task.
+ *
+ * @param context Pointer to a HTTP easy context
+ */
+static void rn_http_easy_client_unpark(void *context)
+{
+	rn_http_easy_context_t *econtext = context;
+
+	if (econtext->socket->node.error != 0 || rn_task_start(econtext->socket->node.sched, rn_http_easy_client_process, econtext) != 0) {
+		rn_socket_destroy(econtext->socket);
+		free(econtext);
+	}
+}
+
 /**
- * HTTP client processing callback
+ * HTTP client processing callback.
+ * Idle keep-alive connections get parked: their task and HTTP
+ * context are released until the client sends a new request.
  *
  * @param context Pointer to a HTTP easy context
  */
 static void rn_http_easy_client_process(void *context)
 {
 	int i;
+	int idle;
 	bool found;
 	rn_buffer_t body;
 	rn_http_t http;
 	rn_http_easy_context_t *econtext = context;
 
-	rn_http_init(econtext->socket, &http);
+	if (rn_http_init(econtext->socket, &http) != 0) {
+		rn_socket_destroy(econtext->socket);
+		free(econtext);
+		return;
+	}
 	while (rn_http_request_get(&http)) {
 		for (i = 0, found = false; i < econtext->nbroutes && found == false; i++) {
 			if (econtext->routes[i].uri == NULL ||
@@ -90,6 +147,14 @@ static void rn_http_easy_client_process(void *context)
 			rn_http_response_send(&http, &body);
 		}
 		rn_http_reset(&http);
+		idle = rn_http_easy_client_idle(econtext->socket);
+		if (idle < 0) {
+			break;
+		}
+		if (idle == 0 && rn_scheduler_waitfor_cb(&econtext->socket->node, RN_MODE_IN, rn_http_easy_client_unpark, econtext) == 0) {
+			rn_http_destroy(&http);
+			return;
+		}
 	}
 	rn_http_destroy(&http);
 	rn_socket_destroy(econtext->socket);
@@ -103,6 +168,7 @@ static void rn_http_easy_client_process(void *context)
  */
 static void rn_http_easy_server_process(void *context)
 {
+	rn_sched_t *sched;
 	rn_socket_t *client;
 	rn_http_easy_context_t *c_context;
 	rn_http_easy_context_t *s_context = context;
@@ -120,6 +186,14 @@ static void rn_http_easy_server_process(void *context)
 		c_context->nbroutes = s_context->nbroutes;
 		rn_task_start(s_context->socket->node.sched, rn_http_easy_client_process, c_context);
 	}
+	sched = s_context->socket->node.sched;
+	if (rn_error == ECANCELED && sched->parent != NULL && !__atomic_load_n(&sched->parent->draining, __ATOMIC_RELAXED)) {
+		/* Retired spawn, the parent scheduler takes the listening socket over */
+		if (rn_socket_migrate(sched->parent, s_context->socket) == 0 &&
+		rn_task_start_remote(sched->parent, rn_http_easy_server_process, s_context) == 0) {
+			return;
+		}
+	}
 	rn_socket_destroy(s_context->socket);
 	free(s_context);
 }
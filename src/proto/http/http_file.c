@@ -10,36 +10,45 @@
 
 #include "rinoo/proto/http/module.h"
 
-int rn_http_send_dir(rn_http_t *http, const char *path)
+typedef struct rn_http_dir_s {
+	const char *path;
+	rn_buffer_t *result;
+} rn_http_dir_t;
+
+typedef struct rn_http_stat_s {
+	const char *path;
+	struct stat stats;
+} rn_http_stat_t;
+
+/**
+ * Builds a directory listing page.
+ * This function blocks and is run on the offload pool.
+ *
+ * @param arg Pointer to the directory to list
+ *
+ * @return 0 on success, otherwise -1 and errno is set
+ */
+static int rn_http_dir_list(void *arg)
 {
-	int ret;
 	int flag;
 	DIR *dir;
 	char *hl;
 	char *de;
-	rn_buffer_t *result;
 	struct stat stats;
 	struct dirent *curentry;
+	rn_buffer_t *result;
+	rn_http_dir_t *list = arg;
 
-	XASSERT(http != NULL, -1);
-	XASSERT(path != NULL, -1);
-
-	if (stat(path, &stats) != 0) {
-		rn_error_set(errno);
+	result = list->result;
+	if (stat(list->path, &stats) != 0) {
 		return -1;
 	}
 	if (S_ISDIR(stats.st_mode) == 0) {
-		rn_error_set(EINVAL);
+		errno = EINVAL;
 		return -1;
 	}
-	dir = opendir(path);
+	dir = opendir(list->path);
 	if (dir == NULL) {
-		rn_error_set(errno);
-		return -1;
-	}
-	result = rn_buffer_create(NULL);
-	if (result == NULL) {
-		closedir(dir);
 		return -1;
 	}
 	rn_buffer_print(result,
@@ -109,54 +118,101 @@ int rn_http_send_dir(rn_http_t *http, const char *path)
 		     "  </body>\n"
 		     "</html>\n");
 	closedir(dir);
+	return 0;
+}
+
+int rn_http_send_dir(rn_http_t *http, const char *path)
+{
+	int ret;
+	rn_http_dir_t list;
 
+	XASSERT(http != NULL, -1);
+	XASSERT(path != NULL, -1);
+
+	list.path = path;
+	list.result = rn_buffer_create(NULL);
+	if (list.result == NULL) {
+		return -1;
+	}
+	if (rn_task_offload(http->socket->node.sched, rn_http_dir_list, &list) != 0) {
+		rn_error_set(errno);
+		rn_buffer_destroy(list.result);
+		return -1;
+	}
 	http->response.code = 200;
-	ret = rn_http_response_send(http, result);
-	rn_buffer_destroy(result);
+	ret = rn_http_response_send(http, list.result);
+	rn_buffer_destroy(list.result);
 	return ret;
 }
 
+/**
+ * Gets file status.
+ * This function blocks and is run on the offload pool.
+ *
+ * @param arg Pointer to the file path
+ *
+ * @return 0 on success, otherwise -1 and errno is set
+ */
+static int rn_http_file_stat(void *arg)
+{
+	rn_http_stat_t *file = arg;
+
+	return stat(file->path, &file->stats);
+}
+
 int rn_http_send_file(rn_http_t *http, const char *path)
 {
-	int ret;
-	int fd;
-	void *ptr;
-	rn_buffer_t dummy;
-	struct stat stats;
+	char *chunk;
+	size_t size;
+	ssize_t res;
+	rn_file_t *file;
+	rn_http_stat_t info;
 
 	XASSERT(http != NULL, -1);
 	XASSERT(path != NULL, -1);
 
-	if (stat(path, &stats) != 0) {
+	info.path = path;
+	if (rn_task_offload(http->socket->node.sched, rn_http_file_stat, &info) != 0) {
 		rn_error_set(errno);
 		return -1;
 	}
-	if (S_ISDIR(stats.st_mode)) {
+	if (S_ISDIR(info.stats.st_mode)) {
 		return rn_http_send_dir(http, path);
 	}
-	if (S_ISREG(stats.st_mode) == 0) {
+	if (S_ISREG(info.stats.st_mode) == 0) {
 		rn_error_set(EINVAL);
 		return -1;
 	}
-	if (stats.st_size == 0) {
-		http->response.code = 200;
+	http->response.code = 200;
+	if (info.stats.st_size == 0) {
 		return rn_http_response_send(http, NULL);
 	}
-	fd = open(path, O_RDONLY);
-	if (fd < 0) {
-		rn_error_set(errno);
+	file = rn_file_open(http->socket->node.sched, path, O_RDONLY, 0);
+	if (file == NULL) {
 		return -1;
 	}
-	ptr = mmap(NULL, stats.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
-	if (ptr == MAP_FAILED) {
-		rn_error_set(errno);
-		close(fd);
+	chunk = malloc(RN_HTTP_FILE_CHUNK);
+	if (chunk == NULL) {
+		rn_file_close(file);
 		return -1;
 	}
-	http->response.code = 200;
-	rn_buffer_static(&dummy, ptr, stats.st_size);
-	ret = rn_http_response_send(http, &dummy);
-	munmap(ptr, stats.st_size);
-	close(fd);
-	return ret;
+	if (rn_http_response_prepare(http, info.stats.st_size) != 0 ||
+	    rn_socket_writeb(http->socket, http->response.buffer) != (ssize_t) rn_buffer_size(http->response.buffer)) {
+		goto send_error;
+	}
+	/* File is streamed by chunks, disk reads never block the scheduler */
+	for (size = 0; size < (size_t) info.stats.st_size; size += res) {
+		res = (size_t) info.stats.st_size - size;
+		res = rn_file_read(file, chunk, (res > RN_HTTP_FILE_CHUNK ? RN_HTTP_FILE_CHUNK : res));
+		if (res <= 0 || rn_socket_write(http->socket, chunk, res) != res) {
+			goto send_error;
+		}
+	}
+	free(chunk);
+	rn_file_close(file);
+	return 0;
+send_error:
+	free(chunk);
+	rn_file_close(file);
+	return -1;
 }
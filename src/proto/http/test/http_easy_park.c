@@ -0,0 +1,75 @@
+/**
+ * @file   http_easy_park.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  HTTP easy idle connection parking unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define HTTP_CONTENT	"This content is for test purpose\n"
+
+rn_http_route_t routes[] = {
+	{ .uri = "/", .code = 200, .type = RN_HTTP_ROUTE_STATIC, .content = HTTP_CONTENT },
+};
+
+void http_get(rn_http_t *http)
+{
+	XTEST(rn_http_request_send(http, RN_HTTP_METHOD_GET, "/", NULL) == 0);
+	XTEST(rn_http_response_get(http));
+	XTEST(http->response.code == 200);
+	XTEST(rn_buffer_size(&http->response.content) == strlen(HTTP_CONTENT));
+	rn_http_reset(http);
+}
+
+void http_client(void *sched)
+{
+	rn_addr_t addr;
+	rn_http_t http;
+	rn_socket_t *client;
+	rn_sched_stats_t before;
+	rn_sched_stats_t after;
+
+	rn_addr4(&addr, "127.0.0.1", 4246);
+	client = rn_tcp_client(sched, &addr, 0);
+	XTEST(client != NULL);
+	XTEST(rn_http_init(client, &http) == 0);
+	http_get(&http);
+	rn_stats_get(sched, &before);
+	/* Connection task is not parked yet */
+	http_get(&http);
+	rn_stats_get(sched, &after);
+	XTEST(after.created == before.created);
+	XTEST(rn_task_wait(sched, RN_HTTP_EASY_IDLE + 200) == 0);
+	/* Connection got parked, a new task serves the next request */
+	http_get(&http);
+	rn_stats_get(sched, &after);
+	XTEST(after.created == before.created + 2);
+	rn_http_destroy(&http);
+	rn_socket_destroy(client);
+	rn_scheduler_stop(sched);
+}
+
+/**
+ * Main function for this unit test.
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	rn_addr_t addr;
+	rn_sched_t *sched;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	rn_addr4(&addr, "127.0.0.1", 4246);
+	XTEST(rn_http_easy_server(sched, &addr, routes, 1) == 0);
+	XTEST(rn_task_start(sched, http_client, sched) == 0);
+	rn_scheduler_loop(sched);
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
@@ -0,0 +1,246 @@
+/**
+ * @file   bchannel.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Buffered channel functions
+ *
+ *
+ */
+
+#include "rinoo/scheduler/module.h"
+
+/**
+ * Create a new buffered channel.
+ *
+ * @param sched Pointer to the scheduler to use.
+ * @param capacity Maximum number of pointers held by the channel.
+ *
+ * @return Pointer to the new channel, or NULL if an error occurs.
+ */
+rn_bchannel_t *rn_bchannel(rn_sched_t *sched, uint32_t capacity)
+{
+	rn_bchannel_t *channel;
+
+	XASSERT(sched != NULL, NULL);
+	XASSERT(capacity > 0, NULL);
+
+	channel = calloc(1, sizeof(*channel));
+	if (channel == NULL) {
+		return NULL;
+	}
+	channel->ring = malloc(sizeof(*channel->ring) * capacity);
+	if (channel->ring == NULL) {
+		free(channel);
+		return NULL;
+	}
+	channel->capacity = capacity;
+	channel->sched = sched;
+	rn_list(&channel->readers, NULL);
+	rn_list(&channel->writers, NULL);
+	return channel;
+}
+
+/**
+ * Destroy a buffered channel.
+ * Pointers still held by the channel are dropped.
+ *
+ * @param channel Channel to destroy.
+ */
+void rn_bchannel_destroy(rn_bchannel_t *channel)
+{
+	XASSERTN(channel != NULL);
+
+	free(channel->ring);
+	free(channel);
+}
+
+/**
+ * Wakes up the first task waiting in a list.
+ *
+ * @param waiters List of waiting tasks
+ */
+static void rn_bchannel_wake(rn_list_t *waiters)
+{
+	rn_list_node_t *node;
+	rn_bchannel_waiter_t *waiter;
+
+	node = rn_list_pop(waiters);
+	if (node != NULL) {
+		waiter = container_of(node, rn_bchannel_waiter_t, node);
+		waiter->woken = true;
+		rn_task_schedule(waiter->task, 0);
+	}
+}
+
+/**
+ * Suspends the current task until it gets woken up.
+ *
+ * @param channel Pointer to the channel to use
+ * @param reader Whether the task waits for something to read, or for room to write
+ *
+ * @return 0 on success, otherwise -1
+ */
+static int rn_bchannel_wait(rn_bchannel_t *channel, bool reader)
+{
+	int ret;
+	rn_bchannel_waiter_t waiter;
+
+	if (rn_task_self() == NULL) {
+		rn_error_set(EINVAL);
+		return -1;
+	}
+	rn_bchannel_watch(channel, &waiter, reader);
+	ret = rn_task_release(channel->sched);
+	rn_bchannel_unwatch(channel, &waiter, reader, false);
+	return ret;
+}
+
+/**
+ * Checks whether a task can get from, or put in, a buffered channel
+ * without blocking. A closed channel is always ready.
+ *
+ * @param channel Channel to check.
+ * @param reader Whether to check for reading, or writing.
+ *
+ * @return true if the channel is ready.
+ */
+bool rn_bchannel_ready(rn_bchannel_t *channel, bool reader)
+{
+	if (channel->closed) {
+		return true;
+	}
+	return (reader ? channel->count > 0 : channel->count < channel->capacity);
+}
+
+/**
+ * Adds the current task to the waiting tasks of a buffered channel.
+ * The task gets scheduled once the channel becomes ready.
+ *
+ * @param channel Channel to watch.
+ * @param waiter Waiter to register, it must be kept until rn_bchannel_unwatch is called.
+ * @param reader Whether to wait for reading, or writing.
+ */
+void rn_bchannel_watch(rn_bchannel_t *channel, rn_bchannel_waiter_t *waiter, bool reader)
+{
+	waiter->woken = false;
+	waiter->task = rn_task_self();
+	rn_list_append((reader ? &channel->readers : &channel->writers), &waiter->node);
+}
+
+/**
+ * Removes a waiter from a buffered channel.
+ * If the waiter has been woken up but won't use the channel, the
+ * wakeup can be forwarded to another waiting task.
+ *
+ * @param channel Channel watched.
+ * @param waiter Waiter to remove.
+ * @param reader Whether the waiter was waiting for reading, or writing.
+ * @param forward Whether a wakeup should be forwarded.
+ */
+void rn_bchannel_unwatch(rn_bchannel_t *channel, rn_bchannel_waiter_t *waiter, bool reader, bool forward)
+{
+	if (!waiter->woken) {
+		rn_list_remove((reader ? &channel->readers : &channel->writers), &waiter->node);
+	} else if (forward) {
+		rn_bchannel_wake((reader ? &channel->readers : &channel->writers));
+	}
+}
+
+/**
+ * Close a buffered channel. Waiting tasks are woken up.
+ * Readers can still get pointers held by the channel, writers fail.
+ *
+ * @param channel Channel to close.
+ */
+void rn_bchannel_close(rn_bchannel_t *channel)
+{
+	XASSERTN(channel != NULL);
+
+	channel->closed = true;
+	while (rn_list_size(&channel->readers) > 0) {
+		rn_bchannel_wake(&channel->readers);
+	}
+	while (rn_list_size(&channel->writers) > 0) {
+		rn_bchannel_wake(&channel->writers);
+	}
+}
+
+/**
+ * Put a pointer in a buffered channel.
+ * This only blocks when the channel is full.
+ *
+ * @param channel Channel to write to.
+ * @param ptr Pointer to put, can't be NULL.
+ *
+ * @return 0 on success, or -1 if an error occurs or the channel is closed.
+ */
+int rn_bchannel_put(rn_bchannel_t *channel, void *ptr)
+{
+	XASSERT(channel != NULL, -1);
+	XASSERT(ptr != NULL, -1);
+
+	if (channel->sched != rn_scheduler_self()) {
+		rn_error_set(EINVAL);
+		return -1;
+	}
+	while (channel->count == channel->capacity && !channel->closed) {
+		if (rn_bchannel_wait(channel, false) != 0) {
+			return -1;
+		}
+	}
+	if (channel->closed) {
+		rn_error_set(EPIPE);
+		return -1;
+	}
+	channel->ring[(channel->head + channel->count) % channel->capacity] = ptr;
+	channel->count++;
+	rn_bchannel_wake(&channel->readers);
+	return 0;
+}
+
+/**
+ * Get a pointer from a buffered channel.
+ * This only blocks when the channel is empty.
+ *
+ * @param channel Channel to read from.
+ *
+ * @return Pointer read, or NULL if an error occurs or the channel is closed and empty.
+ */
+void *rn_bchannel_get(rn_bchannel_t *channel)
+{
+	void *ptr;
+
+	XASSERT(channel != NULL, NULL);
+
+	if (channel->sched != rn_scheduler_self()) {
+		rn_error_set(EINVAL);
+		return NULL;
+	}
+	while (channel->count == 0 && !channel->closed) {
+		if (rn_bchannel_wait(channel, true) != 0) {
+			return NULL;
+		}
+	}
+	if (channel->count == 0) {
+		rn_error_set(EPIPE);
+		return NULL;
+	}
+	ptr = channel->ring[channel->head];
+	channel->head = (channel->head + 1) % channel->capacity;
+	channel->count--;
+	rn_bchannel_wake(&channel->writers);
+	return ptr;
+}
+
+/**
+ * Get the number of pointers held by a buffered channel.
+ *
+ * @param channel Channel to use.
+ *
+ * @return Number of pointers in the channel.
+ */
+uint32_t rn_bchannel_size(rn_bchannel_t *channel)
+{
+	return channel->count;
+}
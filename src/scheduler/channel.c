@@ -61,7 +61,7 @@ void *rn_channel_get(rn_channel_t *channel)
 	channel->buf = NULL;
 	channel->size = 0;
 	channel->task = NULL;
-	rn_task_schedule(task, NULL);
+	rn_task_schedule(task, 0);
 	return result;
 }
 
@@ -110,7 +110,7 @@ int rn_channel_read(rn_channel_t *channel, void *dest, size_t size)
 		channel->buf = NULL;
 		channel->size = 0;
 		channel->task = NULL;
-		rn_task_schedule(task, NULL);
+		rn_task_schedule(task, 0);
 	}
 	return size;
 }
@@ -137,7 +137,7 @@ int rn_channel_write(rn_channel_t *channel, void *buf, size_t size)
 	channel->size = size;
 	task = channel->task;
 	if (task != NULL) {
-		rn_task_schedule(task, NULL);
+		rn_task_schedule(task, 0);
 	}
 	channel->task = rn_task_self();
 	rn_task_release(sched);
@@ -10,6 +10,41 @@
 
 #include "rinoo/scheduler/module.h"
 
+const rn_poller_class_t rn_poller_epoll = {
+	.name = "epoll",
+	.init = rn_epoll_init,
+	.destroy = rn_epoll_destroy,
+	.insert = rn_epoll_insert,
+	.addmode = rn_epoll_addmode,
+	.remove = rn_epoll_remove,
+	.poll = rn_epoll_poll
+};
+
+/**
+ * Allocates the event array. The array only holds events of the last
+ * epoll_wait call, which have been processed, so its content is not kept.
+ * It is page aligned so that it can be moved to the NUMA node of a
+ * pinned scheduler without moving anything else.
+ *
+ * @param sched Pointer to the scheduler to use.
+ * @param nbevents Number of events the array can hold.
+ *
+ * @return 0 if succeeds, else -1.
+ */
+static int rn_epoll_events(rn_sched_t *sched, int nbevents)
+{
+	struct epoll_event *events;
+
+	if (posix_memalign((void **) &events, getpagesize(), sizeof(*events) * nbevents) != 0) {
+		return -1;
+	}
+	free(sched->epoll.events);
+	sched->epoll.events = events;
+	sched->epoll.nbevents = nbevents;
+	rn_spawn_mbind(sched, events, sizeof(*events) * nbevents);
+	return 0;
+}
+
 /**
  * Epoll initialization. It calls epoll_create and
  * initializes internal structures.
@@ -25,8 +60,13 @@ int rn_epoll_init(rn_sched_t *sched)
 	sched->epoll.fd = epoll_create(42); /* Size does not matter any more ;) */
 	XASSERT(sched->epoll.fd != -1, -1);
 	sched->epoll.curevent = -1;
-	if (sigaction(SIGPIPE, &(struct sigaction){ .sa_handler = SIG_IGN }, NULL) != 0) {
+	if (rn_epoll_events(sched, RN_EPOLL_MIN_EVENTS) != 0) {
 		close(sched->epoll.fd);
+		sched->epoll.fd = -1;
+		return -1;
+	}
+	if (sigaction(SIGPIPE, &(struct sigaction){ .sa_handler = SIG_IGN }, NULL) != 0) {
+		rn_epoll_destroy(sched);
 		return -1;
 	}
 	return 0;
@@ -43,7 +83,10 @@ void rn_epoll_destroy(rn_sched_t *sched)
 
 	if (sched->epoll.fd != -1) {
 		close(sched->epoll.fd);
+		sched->epoll.fd = -1;
 	}
+	free(sched->epoll.events);
+	sched->epoll.events = NULL;
 }
 
 /**
@@ -118,11 +161,12 @@ int rn_epoll_remove(rn_sched_node_t *node)
 
 /**
  * Start polling. It calls epoll_wait.
+ * The event array grows when a batch comes back full.
  *
  * @param sched Pointer to the scheduler to use.
  * @param timeout Maximum time to wait in milliseconds (-1 for no timeout)
  *
- * @return 0 if succeeds, else -1.
+ * @return Number of events received.
  */
 int rn_epoll_poll(rn_sched_t *sched, int timeout)
 {
@@ -131,7 +175,8 @@ int rn_epoll_poll(rn_sched_t *sched, int timeout)
 
 	XASSERT(sched != NULL, -1);
 
-	nbevents = epoll_wait(sched->epoll.fd, sched->epoll.events, RN_EPOLL_MAX_EVENTS, timeout);
+	nbevents = epoll_wait(sched->epoll.fd, sched->epoll.events, sched->epoll.nbevents, timeout);
+	rn_scheduler_clock_update(sched);
 	if (unlikely(nbevents == -1)) {
 		/* We don't want to raise an error in this case */
 		return 0;
@@ -150,5 +195,9 @@ int rn_epoll_poll(rn_sched_t *sched, int timeout)
 		}
 	}
 	sched->epoll.curevent = -1;
-	return 0;
+	if (nbevents == sched->epoll.nbevents && nbevents < RN_EPOLL_MAX_EVENTS) {
+		/* Failing to grow is not an error */
+		rn_epoll_events(sched, nbevents * 2);
+	}
+	return nbevents;
 }
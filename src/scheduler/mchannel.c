@@ -0,0 +1,435 @@
+/**
+ * @file   mchannel.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Cross-scheduler channel functions
+ *
+ *
+ */
+
+#include "rinoo/scheduler/module.h"
+
+/**
+ * Create a new cross-scheduler channel.
+ *
+ * @param capacity Maximum number of pointers held by the channel, rounded up to a power of 2.
+ *
+ * @return Pointer to the new channel, or NULL if an error occurs.
+ */
+rn_mchannel_t *rn_mchannel(uint32_t capacity)
+{
+	uint64_t i;
+	uint64_t size;
+	rn_mchannel_t *channel;
+
+	XASSERT(capacity > 0, NULL);
+
+	if (posix_memalign((void **) &channel, 64, sizeof(*channel)) != 0) {
+		return NULL;
+	}
+	memset(channel, 0, sizeof(*channel));
+	for (size = 1; size < capacity; size <<= 1);
+	channel->cells = malloc(sizeof(*channel->cells) * size);
+	if (channel->cells == NULL) {
+		free(channel);
+		return NULL;
+	}
+	for (i = 0; i < size; i++) {
+		channel->cells[i].seq = i;
+		channel->cells[i].data = NULL;
+	}
+	channel->mask = size - 1;
+	rn_list(&channel->readers, NULL);
+	rn_list(&channel->writers, NULL);
+	if (pthread_mutex_init(&channel->lock, NULL) != 0) {
+		free(channel->cells);
+		free(channel);
+		return NULL;
+	}
+	return channel;
+}
+
+/**
+ * Destroy a cross-scheduler channel.
+ * No task must be using it anymore.
+ *
+ * @param channel Channel to destroy.
+ */
+void rn_mchannel_destroy(rn_mchannel_t *channel)
+{
+	XASSERTN(channel != NULL);
+
+	pthread_mutex_destroy(&channel->lock);
+	free(channel->cells);
+	free(channel);
+}
+
+/**
+ * Remote message handler scheduling a woken task on its own scheduler.
+ *
+ * @param sched Pointer to the scheduler running the task
+ * @param msg Pointer to the waiter message
+ */
+static void rn_mchannel_resume(rn_sched_t *unused(sched), rn_remote_msg_t *msg)
+{
+	rn_mchannel_waiter_t *waiter;
+
+	waiter = container_of(msg, rn_mchannel_waiter_t, msg);
+	waiter->delivered = true;
+	rn_task_schedule(waiter->task, 0);
+}
+
+/**
+ * Wakes up a waiter. The waiter must have been removed from its list.
+ *
+ * @param waiter Pointer to the waiter to wake up
+ */
+static void rn_mchannel_notify(rn_mchannel_waiter_t *waiter)
+{
+	if (waiter->task->sched == rn_scheduler_self()) {
+		waiter->delivered = true;
+		rn_task_schedule(waiter->task, 0);
+	} else {
+		rn_remote_push(waiter->task->sched, &waiter->msg);
+	}
+}
+
+/**
+ * Wakes up the first task waiting in a list, if any.
+ *
+ * @param channel Pointer to the channel to use
+ * @param waiters List of waiting tasks
+ * @param nbwaiters Number of waiting tasks in the list
+ */
+static void rn_mchannel_wake(rn_mchannel_t *channel, rn_list_t *waiters, uint32_t *nbwaiters)
+{
+	rn_list_node_t *node;
+	rn_mchannel_waiter_t *waiter;
+
+	/* Pairs with the fence in rn_mchannel_watch, no wakeup can be missed */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(nbwaiters, __ATOMIC_RELAXED) == 0) {
+		return;
+	}
+	waiter = NULL;
+	pthread_mutex_lock(&channel->lock);
+	node = rn_list_pop(waiters);
+	if (node != NULL) {
+		__atomic_sub_fetch(nbwaiters, 1, __ATOMIC_RELAXED);
+		waiter = container_of(node, rn_mchannel_waiter_t, node);
+		waiter->woken = true;
+	}
+	pthread_mutex_unlock(&channel->lock);
+	if (waiter != NULL) {
+		rn_mchannel_notify(waiter);
+	}
+}
+
+/**
+ * Checks whether a channel is empty.
+ *
+ * @param channel Pointer to the channel to use
+ *
+ * @return true if there is nothing to read
+ */
+static bool rn_mchannel_empty(rn_mchannel_t *channel)
+{
+	uint64_t pos;
+
+	pos = __atomic_load_n(&channel->tail, __ATOMIC_RELAXED);
+	return ((int64_t) (__atomic_load_n(&channel->cells[pos & channel->mask].seq, __ATOMIC_ACQUIRE) - (pos + 1)) < 0);
+}
+
+/**
+ * Checks whether a channel is full.
+ *
+ * @param channel Pointer to the channel to use
+ *
+ * @return true if there is no room to write
+ */
+static bool rn_mchannel_full(rn_mchannel_t *channel)
+{
+	uint64_t pos;
+
+	pos = __atomic_load_n(&channel->head, __ATOMIC_RELAXED);
+	return ((int64_t) (__atomic_load_n(&channel->cells[pos & channel->mask].seq, __ATOMIC_ACQUIRE) - pos) < 0);
+}
+
+/**
+ * Checks whether a task can get from, or put in, a cross-scheduler
+ * channel without blocking. A closed channel is always ready.
+ *
+ * @param channel Channel to check.
+ * @param reader Whether to check for reading, or writing.
+ *
+ * @return true if the channel is ready.
+ */
+bool rn_mchannel_ready(rn_mchannel_t *channel, bool reader)
+{
+	if (__atomic_load_n(&channel->closed, __ATOMIC_RELAXED)) {
+		return true;
+	}
+	return (reader ? !rn_mchannel_empty(channel) : !rn_mchannel_full(channel));
+}
+
+/**
+ * Adds the current task to the waiting tasks of a cross-scheduler channel,
+ * unless the channel is already ready. The task gets scheduled once the
+ * channel becomes ready, possibly from another scheduler.
+ *
+ * @param channel Channel to watch.
+ * @param waiter Waiter to register, it must be kept until rn_mchannel_unwatch is called.
+ * @param reader Whether to wait for reading, or writing.
+ *
+ * @return 1 if the channel is ready and the waiter has not been registered, otherwise 0.
+ */
+int rn_mchannel_watch(rn_mchannel_t *channel, rn_mchannel_waiter_t *waiter, bool reader)
+{
+	uint32_t *nbwaiters;
+
+	waiter->woken = false;
+	waiter->delivered = false;
+	waiter->task = rn_task_self();
+	waiter->msg.handler = rn_mchannel_resume;
+	nbwaiters = (reader ? &channel->nbreaders : &channel->nbwriters);
+	pthread_mutex_lock(&channel->lock);
+	__atomic_add_fetch(nbwaiters, 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (rn_mchannel_ready(channel, reader)) {
+		__atomic_sub_fetch(nbwaiters, 1, __ATOMIC_RELAXED);
+		pthread_mutex_unlock(&channel->lock);
+		return 1;
+	}
+	rn_list_append((reader ? &channel->readers : &channel->writers), &waiter->node);
+	pthread_mutex_unlock(&channel->lock);
+	return 0;
+}
+
+/**
+ * Removes a waiter from a cross-scheduler channel.
+ * If the waiter has already been woken up, this waits for the wakeup
+ * to be delivered, as the waiter can't be released before. The wakeup
+ * can then be forwarded to another waiting task.
+ *
+ * @param channel Channel watched.
+ * @param waiter Waiter to remove.
+ * @param reader Whether the waiter was waiting for reading, or writing.
+ * @param forward Whether a wakeup should be forwarded.
+ */
+void rn_mchannel_unwatch(rn_mchannel_t *channel, rn_mchannel_waiter_t *waiter, bool reader, bool forward)
+{
+	bool woken;
+	rn_sched_t *sched;
+
+	pthread_mutex_lock(&channel->lock);
+	woken = waiter->woken;
+	if (!woken) {
+		rn_list_remove((reader ? &channel->readers : &channel->writers), &waiter->node);
+		__atomic_sub_fetch((reader ? &channel->nbreaders : &channel->nbwriters), 1, __ATOMIC_RELAXED);
+	}
+	pthread_mutex_unlock(&channel->lock);
+	if (!woken) {
+		return;
+	}
+	sched = waiter->task->sched;
+	sched->nbpending++;
+	while (!waiter->delivered && rn_task_release(sched) == 0);
+	sched->nbpending--;
+	if (forward) {
+		if (reader) {
+			rn_mchannel_wake(channel, &channel->readers, &channel->nbreaders);
+		} else {
+			rn_mchannel_wake(channel, &channel->writers, &channel->nbwriters);
+		}
+	}
+}
+
+/**
+ * Suspends the current task until the channel state changes.
+ * While waiting, the task keeps its scheduler running, as it
+ * can be woken up by another scheduler.
+ *
+ * @param channel Pointer to the channel to use
+ * @param reader Whether the task waits for something to read, or for room to write
+ *
+ * @return 0 on success, otherwise -1
+ */
+static int rn_mchannel_wait(rn_mchannel_t *channel, bool reader)
+{
+	int ret;
+	rn_sched_t *sched;
+	rn_mchannel_waiter_t waiter;
+
+	sched = rn_scheduler_self();
+	if (sched == NULL || rn_task_self() == NULL || rn_task_self() == &sched->driver.main) {
+		rn_error_set(EINVAL);
+		return -1;
+	}
+	if (rn_mchannel_watch(channel, &waiter, reader) != 0) {
+		return 0;
+	}
+	sched->nbpending++;
+	ret = rn_task_release(sched);
+	sched->nbpending--;
+	rn_mchannel_unwatch(channel, &waiter, reader, false);
+	return ret;
+}
+
+/**
+ * Close a cross-scheduler channel. Waiting tasks are woken up.
+ * Readers can still get pointers held by the channel, writers fail.
+ *
+ * @param channel Channel to close.
+ */
+void rn_mchannel_close(rn_mchannel_t *channel)
+{
+	rn_list_t waiters;
+	rn_list_node_t *node;
+	rn_mchannel_waiter_t *waiter;
+
+	XASSERTN(channel != NULL);
+
+	rn_list(&waiters, NULL);
+	pthread_mutex_lock(&channel->lock);
+	__atomic_store_n(&channel->closed, true, __ATOMIC_SEQ_CST);
+	while ((node = rn_list_pop(&channel->readers)) != NULL || (node = rn_list_pop(&channel->writers)) != NULL) {
+		container_of(node, rn_mchannel_waiter_t, node)->woken = true;
+		rn_list_append(&waiters, node);
+	}
+	channel->nbreaders = 0;
+	channel->nbwriters = 0;
+	pthread_mutex_unlock(&channel->lock);
+	while ((node = rn_list_pop(&waiters)) != NULL) {
+		waiter = container_of(node, rn_mchannel_waiter_t, node);
+		rn_mchannel_notify(waiter);
+	}
+}
+
+/**
+ * Put a pointer in a cross-scheduler channel without blocking.
+ * This function can be called from any thread.
+ *
+ * @param channel Channel to write to.
+ * @param ptr Pointer to put, can't be NULL.
+ *
+ * @return 0 on success, or -1 if the channel is full or closed.
+ */
+int rn_mchannel_tryput(rn_mchannel_t *channel, void *ptr)
+{
+	int64_t diff;
+	uint64_t pos;
+	rn_mchannel_cell_t *cell;
+
+	XASSERT(channel != NULL, -1);
+	XASSERT(ptr != NULL, -1);
+
+	if (__atomic_load_n(&channel->closed, __ATOMIC_RELAXED)) {
+		rn_error_set(EPIPE);
+		return -1;
+	}
+	pos = __atomic_load_n(&channel->head, __ATOMIC_RELAXED);
+	for (;;) {
+		cell = &channel->cells[pos & channel->mask];
+		diff = (int64_t) (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - pos);
+		if (diff == 0) {
+			if (__atomic_compare_exchange_n(&channel->head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				break;
+			}
+		} else if (diff < 0) {
+			rn_error_set(EAGAIN);
+			return -1;
+		} else {
+			pos = __atomic_load_n(&channel->head, __ATOMIC_RELAXED);
+		}
+	}
+	cell->data = ptr;
+	__atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+	rn_mchannel_wake(channel, &channel->readers, &channel->nbreaders);
+	return 0;
+}
+
+/**
+ * Get a pointer from a cross-scheduler channel without blocking.
+ * This function can be called from any thread.
+ *
+ * @param channel Channel to read from.
+ *
+ * @return Pointer read, or NULL if the channel is empty.
+ */
+void *rn_mchannel_tryget(rn_mchannel_t *channel)
+{
+	void *ptr;
+	int64_t diff;
+	uint64_t pos;
+	rn_mchannel_cell_t *cell;
+
+	XASSERT(channel != NULL, NULL);
+
+	pos = __atomic_load_n(&channel->tail, __ATOMIC_RELAXED);
+	for (;;) {
+		cell = &channel->cells[pos & channel->mask];
+		diff = (int64_t) (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - (pos + 1));
+		if (diff == 0) {
+			if (__atomic_compare_exchange_n(&channel->tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				break;
+			}
+		} else if (diff < 0) {
+			rn_error_set(EAGAIN);
+			return NULL;
+		} else {
+			pos = __atomic_load_n(&channel->tail, __ATOMIC_RELAXED);
+		}
+	}
+	ptr = cell->data;
+	__atomic_store_n(&cell->seq, pos + channel->mask + 1, __ATOMIC_RELEASE);
+	rn_mchannel_wake(channel, &channel->writers, &channel->nbwriters);
+	return ptr;
+}
+
+/**
+ * Put a pointer in a cross-scheduler channel.
+ * This only blocks when the channel is full.
+ *
+ * @param channel Channel to write to.
+ * @param ptr Pointer to put, can't be NULL.
+ *
+ * @return 0 on success, or -1 if an error occurs or the channel is closed.
+ */
+int rn_mchannel_put(rn_mchannel_t *channel, void *ptr)
+{
+	while (rn_mchannel_tryput(channel, ptr) != 0) {
+		if (rn_error != EAGAIN || rn_mchannel_wait(channel, false) != 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Get a pointer from a cross-scheduler channel.
+ * This only blocks when the channel is empty.
+ *
+ * @param channel Channel to read from.
+ *
+ * @return Pointer read, or NULL if an error occurs or the channel is closed and empty.
+ */
+void *rn_mchannel_get(rn_mchannel_t *channel)
+{
+	void *ptr;
+
+	while ((ptr = rn_mchannel_tryget(channel)) == NULL) {
+		if (__atomic_load_n(&channel->closed, __ATOMIC_SEQ_CST)) {
+			/* Last check, a pointer might have been put before closing */
+			ptr = rn_mchannel_tryget(channel);
+			if (ptr == NULL) {
+				rn_error_set(EPIPE);
+			}
+			return ptr;
+		}
+		if (rn_mchannel_wait(channel, true) != 0) {
+			return NULL;
+		}
+	}
+	return ptr;
+}
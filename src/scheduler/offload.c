@@ -0,0 +1,268 @@
+/**
+ * @file   offload.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Blocking call offloading functions
+ *
+ *
+ */
+
+#include "rinoo/scheduler/module.h"
+
+/**
+ * Reads the monotonic clock.
+ *
+ * @return Current time in ns
+ */
+static inline uint64_t rn_offload_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Gets the main scheduler, owning the offload pool.
+ *
+ * @param sched Pointer to a scheduler or one of its spawns
+ *
+ * @return Pointer to the main scheduler
+ */
+static rn_sched_t *rn_offload_owner(rn_sched_t *sched)
+{
+	while (sched->parent != NULL) {
+		sched = sched->parent;
+	}
+	return sched;
+}
+
+/**
+ * Remote message handler resuming a task once its job is done.
+ *
+ * @param sched Pointer to the scheduler running the task
+ * @param msg Pointer to the job message
+ */
+static void rn_offload_complete(rn_sched_t *unused(sched), rn_remote_msg_t *msg)
+{
+	rn_offload_job_t *job;
+
+	job = container_of(msg, rn_offload_job_t, msg);
+	job->done = true;
+	rn_task_schedule(job->task, 0);
+}
+
+/**
+ * Worker thread loop.
+ *
+ * @param arg Pointer to the offload pool
+ *
+ * @return NULL
+ */
+static void *rn_offload_worker(void *arg)
+{
+	uint64_t start;
+	uint64_t wait;
+	rn_list_node_t *node;
+	rn_offload_t *pool = arg;
+	rn_offload_job_t *job;
+
+	pthread_mutex_lock(&pool->lock);
+	for (;;) {
+		while (!pool->stop && rn_list_size(&pool->jobs) == 0) {
+			pthread_cond_wait(&pool->cond, &pool->lock);
+		}
+		node = rn_list_pop(&pool->jobs);
+		if (node == NULL) {
+			break;
+		}
+		pool->stats.depth--;
+		pthread_mutex_unlock(&pool->lock);
+		job = container_of(node, rn_offload_job_t, node);
+		start = rn_offload_now();
+		errno = 0;
+		job->ret = job->function(job->arg);
+		job->error = errno;
+		wait = start - job->queued;
+		start = rn_offload_now() - start;
+		rn_remote_push(job->task->sched, &job->msg);
+		pthread_mutex_lock(&pool->lock);
+		pool->stats.jobs++;
+		pool->stats.wait_time += wait;
+		pool->stats.run_time += start;
+		if (wait > pool->stats.max_wait) {
+			pool->stats.max_wait = wait;
+		}
+	}
+	pthread_mutex_unlock(&pool->lock);
+	return NULL;
+}
+
+/**
+ * Starts the offload pool of a scheduler.
+ * The pool is shared with spawns and is started with
+ * RN_OFFLOAD_THREADS threads on first use otherwise.
+ *
+ * @param sched Pointer to the main scheduler
+ * @param nbthreads Number of worker threads
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_offload_start(rn_sched_t *sched, uint32_t nbthreads)
+{
+	uint32_t i;
+	rn_offload_t *pool;
+
+	XASSERT(sched != NULL, -1);
+	XASSERT(nbthreads > 0, -1);
+
+	sched = rn_offload_owner(sched);
+	pthread_mutex_lock(&sched->steal.family);
+	if (sched->offload != NULL) {
+		pthread_mutex_unlock(&sched->steal.family);
+		rn_error_set(EBUSY);
+		return -1;
+	}
+	pool = calloc(1, sizeof(*pool));
+	if (pool == NULL) {
+		pthread_mutex_unlock(&sched->steal.family);
+		return -1;
+	}
+	pool->threads = calloc(nbthreads, sizeof(*pool->threads));
+	if (pool->threads == NULL) {
+		free(pool);
+		pthread_mutex_unlock(&sched->steal.family);
+		return -1;
+	}
+	rn_list(&pool->jobs, NULL);
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->cond, NULL);
+	for (i = 0; i < nbthreads; i++) {
+		if (pthread_create(&pool->threads[i], NULL, rn_offload_worker, pool) != 0) {
+			break;
+		}
+	}
+	if (i == 0) {
+		/* Never published, no one else can see the pool */
+		pthread_mutex_unlock(&sched->steal.family);
+		pthread_cond_destroy(&pool->cond);
+		pthread_mutex_destroy(&pool->lock);
+		free(pool->threads);
+		free(pool);
+		return -1;
+	}
+	pool->nbthreads = i;
+	__atomic_store_n(&sched->offload, pool, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&sched->steal.family);
+	return 0;
+}
+
+/**
+ * Stops the offload pool of a scheduler, waiting for pending jobs.
+ *
+ * @param sched Pointer to the main scheduler
+ */
+void rn_offload_destroy(rn_sched_t *sched)
+{
+	uint32_t i;
+	rn_offload_t *pool;
+
+	XASSERTN(sched != NULL);
+
+	pool = sched->offload;
+	if (pool == NULL) {
+		return;
+	}
+	pthread_mutex_lock(&pool->lock);
+	pool->stop = true;
+	pthread_cond_broadcast(&pool->cond);
+	pthread_mutex_unlock(&pool->lock);
+	for (i = 0; i < pool->nbthreads; i++) {
+		pthread_join(pool->threads[i], NULL);
+	}
+	pthread_cond_destroy(&pool->cond);
+	pthread_mutex_destroy(&pool->lock);
+	free(pool->threads);
+	free(pool);
+	sched->offload = NULL;
+}
+
+/**
+ * Gets offload pool metrics. Times are in ns.
+ * Metrics are zeroed if the pool has not been started.
+ *
+ * @param sched Pointer to the scheduler, or one of its spawns
+ * @param stats Pointer to the metrics to fill
+ */
+void rn_offload_stats(rn_sched_t *sched, rn_offload_stats_t *stats)
+{
+	rn_offload_t *pool;
+
+	XASSERTN(sched != NULL);
+	XASSERTN(stats != NULL);
+
+	pool = __atomic_load_n(&rn_offload_owner(sched)->offload, __ATOMIC_ACQUIRE);
+	if (pool == NULL) {
+		memset(stats, 0, sizeof(*stats));
+		return;
+	}
+	pthread_mutex_lock(&pool->lock);
+	*stats = pool->stats;
+	pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * Runs a blocking function on the offload pool.
+ * The current task is suspended until the function returns, its
+ * scheduler keeps running other tasks meanwhile. errno is set to
+ * the value it had in the worker thread after the call.
+ * Outside of a task, the function is called directly.
+ *
+ * @param sched Pointer to the scheduler running the current task
+ * @param function Function to run
+ * @param arg Function argument
+ *
+ * @return The function return value, or -1 if the pool can't be started
+ */
+int rn_task_offload(rn_sched_t *sched, int (*function)(void *arg), void *arg)
+{
+	rn_sched_t *owner;
+	rn_offload_t *pool;
+	rn_offload_job_t job;
+
+	XASSERT(function != NULL, -1);
+
+	if (sched == NULL || rn_task_driver_getcurrent(sched) == &sched->driver.main) {
+		return function(arg);
+	}
+	owner = rn_offload_owner(sched);
+	pool = __atomic_load_n(&owner->offload, __ATOMIC_ACQUIRE);
+	if (pool == NULL) {
+		if (rn_offload_start(owner, RN_OFFLOAD_THREADS) != 0 && rn_error != EBUSY) {
+			return -1;
+		}
+		pool = __atomic_load_n(&owner->offload, __ATOMIC_ACQUIRE);
+	}
+	job.done = false;
+	job.arg = arg;
+	job.function = function;
+	job.task = rn_task_driver_getcurrent(sched);
+	job.msg.handler = rn_offload_complete;
+	job.queued = rn_offload_now();
+	pthread_mutex_lock(&pool->lock);
+	rn_list_append(&pool->jobs, &job.node);
+	if (++pool->stats.depth > pool->stats.max_depth) {
+		pool->stats.max_depth = pool->stats.depth;
+	}
+	pthread_cond_signal(&pool->cond);
+	pthread_mutex_unlock(&pool->lock);
+	sched->nbpending++;
+	/* The job lives in the task stack, the task can't go before it is done */
+	while (!job.done) {
+		rn_task_release(sched);
+	}
+	sched->nbpending--;
+	errno = job.error;
+	return job.ret;
+}
@@ -0,0 +1,150 @@
+/**
+ * @file   remote.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Cross-scheduler message queue functions
+ *
+ *
+ */
+
+#include "rinoo/scheduler/module.h"
+
+/**
+ * Initializes the remote queue of a scheduler.
+ * It creates an eventfd and registers it in the scheduler poller.
+ * The eventfd node is not counted as a pending node, so that an
+ * idle scheduler still stops unless it is kept alive.
+ *
+ * @param sched Pointer to the scheduler to use
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_remote_init(rn_sched_t *sched)
+{
+	XASSERT(sched != NULL, -1);
+
+	sched->remote.head = NULL;
+	sched->remote.node.fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (sched->remote.node.fd == -1) {
+		return -1;
+	}
+	sched->remote.node.sched = sched;
+	if (sched->poller->insert(&sched->remote.node, RN_MODE_IN) != 0) {
+		close(sched->remote.node.fd);
+		sched->remote.node.fd = -1;
+		return -1;
+	}
+	rn_mode_registered_set(&sched->remote.node, RN_MODE_IN);
+	return 0;
+}
+
+/**
+ * Destroys the remote queue of a scheduler.
+ * Pending messages are processed first so that their handlers
+ * can release them.
+ *
+ * @param sched Pointer to the scheduler to use
+ */
+void rn_remote_destroy(rn_sched_t *sched)
+{
+	XASSERTN(sched != NULL);
+
+	if (sched->remote.node.fd == -1) {
+		return;
+	}
+	rn_remote_process(sched);
+	close(sched->remote.node.fd);
+	sched->remote.node.fd = -1;
+}
+
+/**
+ * Pushes a message to a scheduler remote queue.
+ * This function can be called from any thread. The message handler
+ * will be called by the thread running the target scheduler.
+ *
+ * @param sched Pointer to the target scheduler
+ * @param msg Pointer to the message to push
+ *
+ * @return 0 once the message is queued, or -1 if it has not been queued
+ */
+int rn_remote_push(rn_sched_t *sched, rn_remote_msg_t *msg)
+{
+	rn_remote_msg_t *head;
+
+	XASSERT(sched != NULL, -1);
+	XASSERT(msg != NULL, -1);
+	XASSERT(msg->handler != NULL, -1);
+
+	head = __atomic_load_n(&sched->remote.head, __ATOMIC_RELAXED);
+	do {
+		msg->next = head;
+	} while (!__atomic_compare_exchange_n(&sched->remote.head, &head, msg, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+	if (head == NULL) {
+		/*
+		 * Queue was empty, consumer needs to be notified. The message is
+		 * queued already, if the wakeup fails it gets handled on the
+		 * next poll or by rn_remote_destroy.
+		 */
+		rn_remote_wakeup(sched);
+	}
+	return 0;
+}
+
+/**
+ * Wakes up a scheduler through its remote queue eventfd.
+ *
+ * @param sched Pointer to the scheduler to wake up
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_remote_wakeup(rn_sched_t *sched)
+{
+	uint64_t value = 1;
+
+	XASSERT(sched != NULL, -1);
+
+	if (write(sched->remote.node.fd, &value, sizeof(value)) != sizeof(value) && errno != EAGAIN) {
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Processes all messages pending in a scheduler remote queue.
+ * Messages are handled in the order they were pushed.
+ *
+ * @param sched Pointer to the scheduler to use
+ *
+ * @return Number of processed messages
+ */
+int rn_remote_process(rn_sched_t *sched)
+{
+	int nbmsgs;
+	uint64_t value;
+	rn_remote_msg_t *msg;
+	rn_remote_msg_t *next;
+	rn_remote_msg_t *list;
+
+	XASSERT(sched != NULL, -1);
+
+	/* Reset eventfd before grabbing messages so that no wakeup gets lost */
+	if (read(sched->remote.node.fd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+		return -1;
+	}
+	msg = __atomic_exchange_n(&sched->remote.head, NULL, __ATOMIC_ACQUIRE);
+	list = NULL;
+	while (msg != NULL) {
+		next = msg->next;
+		msg->next = list;
+		list = msg;
+		msg = next;
+	}
+	nbmsgs = 0;
+	for (msg = list; msg != NULL; msg = next) {
+		next = msg->next;
+		msg->handler(sched, msg);
+		nbmsgs++;
+	}
+	return nbmsgs;
+}
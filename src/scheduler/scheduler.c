@@ -20,15 +20,27 @@ rn_sched_t *rn_scheduler(void)
 {
 	rn_sched_t *sched;
 
-	sched = calloc(1, sizeof(*sched));
-	if (sched == NULL) {
+	/* Page aligned so that it can be moved to another NUMA node once pinned */
+	if (posix_memalign((void **) &sched, getpagesize(), sizeof(*sched)) != 0) {
 		return NULL;
 	}
+	memset(sched, 0, sizeof(*sched));
+	sched->cpu = -1;
+	sched->node = -1;
+	sched->remote.node.fd = -1;
+	sched->clock_id = CLOCK_MONOTONIC;
+	sched->poller = &rn_poller_epoll;
+	rn_scheduler_clock_update(sched);
 	if (rn_task_driver_init(sched) != 0) {
 		free(sched);
 		return NULL;
 	}
-	if (rn_epoll_init(sched) != 0) {
+	if (rn_steal_init(sched) != 0) {
+		rn_task_driver_destroy(sched);
+		free(sched);
+		return NULL;
+	}
+	if (sched->poller->init(sched) != 0) {
 		rn_scheduler_destroy(sched);
 		return NULL;
 	}
@@ -36,7 +48,10 @@ rn_sched_t *rn_scheduler(void)
 		rn_scheduler_destroy(sched);
 		return NULL;
 	}
-	gettimeofday(&sched->clock, NULL);
+	if (rn_remote_init(sched) != 0) {
+		rn_scheduler_destroy(sched);
+		return NULL;
+	}
 	return sched;
 }
 
@@ -61,13 +76,25 @@ void rn_scheduler_destroy(rn_sched_t *sched)
 {
 	XASSERTN(sched != NULL);
 
+	rn_watchdog_stop(sched);
+	/* Workers may still complete jobs of spawn tasks */
+	rn_offload_destroy(sched);
 	rn_spawn_destroy(sched);
 	rn_scheduler_stop(sched);
+	rn_remote_destroy(sched);
+	rn_steal_destroy(sched);
+#ifdef RINOO_IO_URING
+	if (sched->poller == &rn_poller_uring) {
+		/* IO operations in flight reference task stacks */
+		rn_uring_flush(sched);
+	}
+#endif /* !RINOO_IO_URING */
 	/* Destroying all pending tasks. */
 	rn_task_driver_stop(sched);
 	rn_list_flush(&sched->nodes, rn_sched_cancel_task);
 	rn_task_driver_destroy(sched);
-	rn_epoll_destroy(sched);
+	sched->poller->destroy(sched);
+	rn_stats_histograms(sched, false);
 	free(sched);
 }
 
@@ -88,8 +115,47 @@ rn_sched_t *rn_scheduler_self(void)
 	return task->sched;
 }
 
+/**
+ * Makes the current task watch a scheduler node for a mode, without
+ * suspending it. The node gets registered in the poller if needed.
+ * The task is resumed by rn_scheduler_wakeup once the event is received.
+ *
+ * @param node Scheduler node to monitor.
+ * @param mode Mode to watch (IN/OUT).
+ *
+ * @return 0 on success, or -1 if an error occurs.
+ */
+int rn_scheduler_watch(rn_sched_node_t *node, rn_sched_mode_t mode)
+{
+	if (rn_mode_registered_get(node) == RN_MODE_NONE) {
+		/* Register both modes once, events get latched until they are consumed */
+		if (unlikely(node->sched->poller->insert(node, RN_MODE_IN | RN_MODE_OUT) != 0)) {
+			return -1;
+		}
+		rn_list_put(&node->sched->nodes, &node->lnode);
+		rn_mode_registered_set(node, RN_MODE_IN | RN_MODE_OUT);
+	}
+	rn_mode_waiting_set(node, mode);
+	node->task = rn_task_driver_getcurrent(node->sched);
+	return 0;
+}
+
+/**
+ * Stops watching a scheduler node. Received events stay latched.
+ *
+ * @param node Scheduler node watched.
+ * @param mode Mode watched (IN/OUT).
+ */
+void rn_scheduler_unwatch(rn_sched_node_t *node, rn_sched_mode_t mode)
+{
+	rn_mode_waiting_unset(node, mode);
+	node->task = NULL;
+}
+
 /**
  * Register a file descriptor in the scheduler and wait for IO.
+ * A file descriptor is registered once, for both modes, and stays
+ * registered until it gets removed or an error occurs (not on timeout).
  *
  * @param node Scheduler node to monitor.
  * @param mode Mode to enable (IN/OUT).
@@ -109,21 +175,9 @@ int rn_scheduler_waitfor(rn_sched_node_t *node, rn_sched_mode_t mode)
 		rn_mode_received_unset(node, mode);
 		return 0;
 	}
-	if (!rn_mode_registered(node, mode)) {
-		if (rn_mode_registered_get(node) == RN_MODE_NONE) {
-			if (unlikely(rn_epoll_insert(node, mode) != 0)) {
-				return -1;
-			}
-			rn_list_put(&node->sched->nodes, &node->lnode);
-		} else {
-			if (unlikely(rn_epoll_addmode(node, rn_mode_registered_get(node) | mode) != 0)) {
-				return -1;
-			}
-		}
-		rn_mode_registered_set(node, mode);
+	if (rn_scheduler_watch(node, mode) != 0) {
+		return -1;
 	}
-	rn_mode_waiting_set(node, mode);
-	node->task = rn_task_driver_getcurrent(node->sched);
 	node->sched->nbpending++;
 	if (unlikely(node->task == &node->sched->driver.main)) {
 		while (!rn_mode_received(node, mode)) {
@@ -150,9 +204,9 @@ int rn_scheduler_waitfor(rn_sched_node_t *node, rn_sched_mode_t mode)
 		return -1;
 	}
 	if (!rn_mode_received(node, mode)) {
-		/* Task has been resumed but no event received, this is a timeout */
+		/* Task has been resumed but no event received, this is a timeout. Node stays registered. */
+		rn_mode_waiting_unset(node, mode);
 		rn_error_set(ETIMEDOUT);
-		rn_scheduler_remove(node);
 		return -1;
 	}
 	rn_mode_waiting_unset(node, mode);
@@ -160,6 +214,50 @@ int rn_scheduler_waitfor(rn_sched_node_t *node, rn_sched_mode_t mode)
 	return 0;
 }
 
+/**
+ * Register a file descriptor in the scheduler and run a callback on IO.
+ * The callback is run by a stackless task, on the scheduler main context,
+ * once the node is ready for the given mode. On error, node->error is
+ * set and the node has been removed from the scheduler before the callback
+ * is run. A callback waits for more events by calling this function again.
+ *
+ * @param node Scheduler node to monitor.
+ * @param mode Mode to enable (IN/OUT).
+ * @param function Callback to run.
+ * @param arg Callback argument.
+ *
+ * @return 0 on success, or -1 if an error occurs.
+ */
+int rn_scheduler_waitfor_cb(rn_sched_node_t *node, rn_sched_mode_t mode, void (*function)(void *arg), void *arg)
+{
+	rn_task_t *task;
+
+	XASSERT(node != NULL, -1);
+	XASSERT(mode != RN_MODE_NONE, -1);
+	XASSERT(function != NULL, -1);
+
+	task = rn_task_stackless(node->sched, function, arg);
+	if (task == NULL) {
+		return -1;
+	}
+	if (node->error != 0 || rn_mode_received(node, mode)) {
+		/* Ready already, the callback runs on the next iteration */
+		if (node->error != 0) {
+			rn_scheduler_remove(node);
+		}
+		rn_mode_received_unset(node, mode);
+		rn_task_schedule(task, 0);
+		return 0;
+	}
+	if (rn_scheduler_watch(node, mode) != 0) {
+		rn_task_destroy(task);
+		return -1;
+	}
+	node->task = task;
+	node->sched->nbpending++;
+	return 0;
+}
+
 /**
  * Unregister a file descriptor from the scheduler.
  *
@@ -173,7 +271,8 @@ int rn_scheduler_remove(rn_sched_node_t *node)
 		/* Node already removed */
 		return -1;
 	}
-	if (rn_epoll_remove(node) != 0) {
+	node->modes = 0;
+	if (node->sched->poller->remove(node) != 0) {
 		return -1;
 	}
 	node->task = NULL;
@@ -182,7 +281,7 @@ int rn_scheduler_remove(rn_sched_node_t *node)
 
 /**
  * Wake up a scheduler node task.
- * This function should be called by the file descriptor monitoring layer (epoll).
+ * This function should be called by the file descriptor monitoring layer (poller).
  *
  * @param node Scheduler node which received IO event.
  * @param mode IO Event.
@@ -190,6 +289,8 @@ int rn_scheduler_remove(rn_sched_node_t *node)
  */
 void rn_scheduler_wakeup(rn_sched_node_t *node, rn_sched_mode_t mode, int error)
 {
+	rn_task_t *task;
+
 	if (node->error == 0) {
 		node->error = error;
 	}
@@ -198,7 +299,18 @@ void rn_scheduler_wakeup(rn_sched_node_t *node, rn_sched_mode_t mode, int error)
 		return;
 	}
 	if (rn_mode_waiting(node, mode) || node->error != 0) {
-		rn_task_resume(node->task);
+		task = node->task;
+		if (task->stackless) {
+			/* Callback form of rn_scheduler_waitfor, the node is released before the callback runs */
+			node->sched->nbpending--;
+			if (node->error != 0) {
+				rn_scheduler_remove(node);
+			} else {
+				rn_scheduler_unwatch(node, RN_MODE_IN | RN_MODE_OUT);
+				rn_mode_received_unset(node, mode);
+			}
+		}
+		rn_task_resume(task);
 	}
 }
 
@@ -212,10 +324,206 @@ void rn_scheduler_stop(rn_sched_t *sched)
 {
 	XASSERTN(sched != NULL);
 
-	if (sched->stop == false) {
-		sched->stop = true;
+	if (!__atomic_exchange_n(&sched->stop, true, __ATOMIC_SEQ_CST)) {
 		rn_spawn_stop(sched);
+		if (rn_scheduler_self() != sched && sched->remote.node.fd != -1) {
+			/* Stopped from another thread, the scheduler might be blocked in its poller */
+			rn_remote_wakeup(sched);
+		}
+	}
+}
+
+/**
+ * Remote message handler starting to drain a scheduler.
+ * Tasks waiting on a listening node are woken up with ECANCELED.
+ *
+ * @param sched Pointer to the scheduler to drain
+ * @param msg Pointer to the drain message
+ */
+static void rn_sched_drain_start(rn_sched_t *sched, rn_remote_msg_t *unused(msg))
+{
+	rn_list_node_t *next;
+	rn_list_node_t *lnode;
+	rn_sched_node_t *node;
+
+	if (sched->drain_timeout > 0) {
+		sched->drain_deadline = sched->clock + sched->drain_timeout;
+	}
+	sched->keepalive = false;
+	for (lnode = rn_list_head(&sched->nodes); lnode != NULL; lnode = next) {
+		next = lnode->next;
+		node = container_of(lnode, rn_sched_node_t, lnode);
+		if (node->listening && node->task != NULL && node->task != &sched->driver.main) {
+			rn_scheduler_wakeup(node, RN_MODE_IN, ECANCELED);
+		}
+	}
+}
+
+/**
+ * Drains a scheduler and its spawns. Listening sockets stop accepting
+ * connections, and schedulers end once their tasks are over. Tasks still
+ * running after the timeout are cancelled, as the schedulers get stopped.
+ * This function can be called from any thread.
+ *
+ * @param sched Pointer to the scheduler to drain.
+ * @param ms Maximum draining time in milliseconds, 0 for no limit.
+ */
+void rn_scheduler_drain(rn_sched_t *sched, uint32_t ms)
+{
+	XASSERTN(sched != NULL);
+
+	if (__atomic_exchange_n(&sched->draining, true, __ATOMIC_SEQ_CST)) {
+		return;
+	}
+	sched->drain_timeout = RN_MS_TO_NS(ms);
+	sched->drain_msg.handler = rn_sched_drain_start;
+	/* Even locally, waiting tasks must be woken up from the main context */
+	rn_remote_push(sched, &sched->drain_msg);
+	rn_spawn_drain(sched, ms);
+}
+
+/**
+ * Keeps a scheduler running when it has nothing left to do.
+ * A scheduler kept alive waits for remote messages until it gets stopped.
+ *
+ * @param sched Pointer to the scheduler to use.
+ * @param keepalive Whether the scheduler should be kept alive.
+ */
+void rn_scheduler_keepalive(rn_sched_t *sched, bool keepalive)
+{
+	XASSERTN(sched != NULL);
+
+	sched->keepalive = keepalive;
+}
+
+/**
+ * Sets the clock used by a scheduler and its spawns.
+ * Only CLOCK_MONOTONIC and CLOCK_MONOTONIC_COARSE are supported.
+ * The coarse clock is cheaper to read but only has a resolution of a few milliseconds.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param clock_id Clock identifier
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_scheduler_clock_set(rn_sched_t *sched, clockid_t clock_id)
+{
+	int i;
+
+	XASSERT(sched != NULL, -1);
+
+	if (clock_id != CLOCK_MONOTONIC && clock_id != CLOCK_MONOTONIC_COARSE) {
+		rn_error_set(EINVAL);
+		return -1;
+	}
+	pthread_mutex_lock(&sched->steal.family);
+	sched->clock_id = clock_id;
+	for (i = 0; i < sched->spawns.count; i++) {
+		/* Spawns which have ended leave an empty slot */
+		if (sched->spawns.thread[i].sched != NULL) {
+			sched->spawns.thread[i].sched->clock_id = clock_id;
+		}
 	}
+	pthread_mutex_unlock(&sched->steal.family);
+	rn_scheduler_clock_update(sched);
+	return 0;
+}
+
+/**
+ * Refreshes the scheduler clock.
+ * This is called once per poll, right after the scheduler wakes up.
+ *
+ * @param sched Pointer to the scheduler to use
+ */
+void rn_scheduler_clock_update(rn_sched_t *sched)
+{
+	struct timespec ts;
+
+	clock_gettime(sched->clock_id, &ts);
+	sched->clock = (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Set the file descriptor monitoring layer of a scheduler.
+ * This must be done before any file descriptor gets registered.
+ *
+ * @param sched Pointer to the scheduler to use.
+ * @param poller Poller class to use (rn_poller_epoll, rn_poller_uring).
+ *
+ * @return 0 on success, otherwise -1.
+ */
+int rn_scheduler_poller_set(rn_sched_t *sched, const rn_poller_class_t *poller)
+{
+	const rn_poller_class_t *old;
+
+	XASSERT(sched != NULL, -1);
+	XASSERT(poller != NULL, -1);
+
+	old = sched->poller;
+	if (old == poller) {
+		return 0;
+	}
+	if (rn_list_size(&sched->nodes) > 0) {
+		rn_error_set(EBUSY);
+		return -1;
+	}
+	if (poller->init(sched) != 0) {
+		return -1;
+	}
+	if (poller->insert(&sched->remote.node, RN_MODE_IN) != 0) {
+		poller->destroy(sched);
+		return -1;
+	}
+	sched->poller = poller;
+	old->destroy(sched);
+	return 0;
+}
+
+/**
+ * Sets the busy poll budget of a scheduler.
+ * Before blocking, the scheduler polls without waiting until an event
+ * arrives or the budget is spent. This trades CPU time for latency.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param us Busy poll budget in microseconds, 0 to disable busy polling
+ */
+void rn_scheduler_busypoll(rn_sched_t *sched, uint32_t us)
+{
+	XASSERTN(sched != NULL);
+
+	sched->busypoll = (uint64_t) us * 1000;
+}
+
+/**
+ * Polls a scheduler without waiting until an event arrives
+ * or its busy poll budget is spent.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param timeout Pointer to the poll timeout, decreased by the time spent
+ *
+ * @return Number of events received
+ */
+static int rn_sched_spin(rn_sched_t *sched, int *timeout)
+{
+	int ret;
+	uint64_t start;
+	uint64_t budget;
+	uint64_t elapsed;
+
+	budget = sched->busypoll;
+	if (*timeout > 0 && budget > RN_MS_TO_NS(*timeout)) {
+		budget = RN_MS_TO_NS(*timeout);
+	}
+	start = sched->clock;
+	do {
+		rn_stats_inc(sched, spins);
+		ret = sched->poller->poll(sched, 0);
+		elapsed = sched->clock - start;
+	} while (ret == 0 && elapsed < budget);
+	if (ret == 0 && *timeout > 0) {
+		*timeout = (elapsed / RN_NS_PER_MS < (uint64_t) *timeout ? *timeout - (int) (elapsed / RN_NS_PER_MS) : 0);
+	}
+	return ret;
 }
 
 /**
@@ -227,11 +535,11 @@ void rn_scheduler_stop(rn_sched_t *sched)
  */
 static bool rn_sched_end(rn_sched_t *sched)
 {
-	return (sched->stop == true || (sched->nbpending == 0 && rn_task_driver_nbpending(sched) == 0));
+	return (__atomic_load_n(&sched->stop, __ATOMIC_RELAXED) || (sched->keepalive == false && sched->nbpending == 0 && rn_task_driver_nbpending(sched) == 0 && !rn_steal_pending(sched)));
 }
 
 /**
- * Check for any task to be executed and poll hte file descriptor monitoring layer (epoll).
+ * Check for any task to be executed and poll the file descriptor monitoring layer (poller).
  *
  * @param sched Pointer to the scheduler.
  *
@@ -239,12 +547,64 @@ static bool rn_sched_end(rn_sched_t *sched)
  */
 int rn_scheduler_poll(rn_sched_t *sched)
 {
+	int ret;
 	int timeout;
+	bool idle;
+	uint64_t start;
 
-	gettimeofday(&sched->clock, NULL);
+	rn_steal_run(sched);
 	timeout = rn_task_driver_run(sched);
+	if (sched->drain_deadline != 0) {
+		if (sched->clock >= sched->drain_deadline) {
+			/* Draining is over, remaining tasks get cancelled */
+			rn_scheduler_stop(sched);
+		} else if (timeout < 0 || (uint64_t) timeout > (sched->drain_deadline - sched->clock) / RN_NS_PER_MS + 1) {
+			timeout = (sched->drain_deadline - sched->clock) / RN_NS_PER_MS + 1;
+		}
+	}
 	if (!rn_sched_end(sched)) {
-		return rn_epoll_poll(sched, timeout);
+		idle = (timeout != 0 && sched->steal.enabled);
+		if (idle) {
+			rn_steal_idle(sched, true);
+			if (rn_steal_pending(sched)) {
+				timeout = 0;
+			}
+		}
+		if (sched->looptime || (timeout != 0 && sched->busypoll > 0)) {
+			/* Otherwise the clock is only read once per wakeup, by the poller */
+			rn_scheduler_clock_update(sched);
+		}
+		start = sched->clock;
+		if (sched->looptime && sched->lastpoll != 0) {
+			rn_stats_add(sched, run_time, start - sched->lastpoll);
+		}
+		ret = 0;
+		if (timeout != 0 && sched->busypoll > 0) {
+			ret = rn_sched_spin(sched, &timeout);
+		}
+		if (ret == 0) {
+			if (timeout != 0) {
+				rn_stats_inc(sched, waits);
+			}
+			ret = sched->poller->poll(sched, timeout);
+		}
+		/* Pollers refresh the clock as soon as they wake up */
+		if (sched->looptime) {
+			rn_stats_add(sched, poll_time, sched->clock - start);
+		}
+		rn_stats_inc(sched, wakeups);
+		if (ret > 0) {
+			rn_stats_add(sched, events, ret);
+		}
+		sched->lastpoll = sched->clock;
+		if (idle) {
+			rn_steal_idle(sched, false);
+		}
+		if (rn_mode_received(&sched->remote.node, RN_MODE_IN)) {
+			rn_mode_received_unset(&sched->remote.node, RN_MODE_IN);
+			rn_remote_process(sched);
+		}
+		return (ret < 0 ? -1 : 0);
 	}
 	return 0;
 }
@@ -258,13 +618,28 @@ int rn_scheduler_poll(rn_sched_t *sched)
  */
 void rn_scheduler_loop(rn_sched_t *sched)
 {
-	sched->stop = false;
+	if (sched->parent == NULL) {
+		/* Spawns can be stopped before their loop starts */
+		sched->stop = false;
+	}
+	rn_scheduler_clock_update(sched);
+	sched->lastpoll = sched->clock;
 	if (rn_spawn_start(sched) != 0) {
 		goto loop_stop;
 	}
+	sched->running = true;
+	rn_watchdog_enter(sched);
 	while (!rn_sched_end(sched)) {
 		rn_scheduler_poll(sched);
 	}
+	rn_watchdog_leave(sched);
+	sched->running = false;
+	if (sched->parent == NULL && !__atomic_load_n(&sched->stop, __ATOMIC_RELAXED)) {
+		rn_spawn_release(sched);
+		rn_spawn_join(sched);
+		sched->draining = false;
+		return;
+	}
 loop_stop:
 	rn_spawn_join(sched);
 }
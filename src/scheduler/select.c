@@ -0,0 +1,252 @@
+/**
+ * @file   select.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Multiple sources waiting functions
+ *
+ *
+ */
+
+#include "rinoo/scheduler/module.h"
+
+/**
+ * Initializes a select entry waiting on a scheduler node.
+ *
+ * @param entry Entry to initialize
+ * @param node Scheduler node to wait on
+ * @param mode Mode to wait for (IN/OUT)
+ */
+void rn_select_node(rn_select_t *entry, rn_sched_node_t *node, rn_sched_mode_t mode)
+{
+	entry->type = RN_SELECT_NODE;
+	entry->mode = mode;
+	entry->node = node;
+}
+
+/**
+ * Initializes a select entry waiting on a buffered channel.
+ *
+ * @param entry Entry to initialize
+ * @param channel Channel to wait on
+ * @param mode RN_MODE_IN to wait for something to get, RN_MODE_OUT for room to put
+ */
+void rn_select_bchannel(rn_select_t *entry, rn_bchannel_t *channel, rn_sched_mode_t mode)
+{
+	entry->type = RN_SELECT_BCHANNEL;
+	entry->mode = mode;
+	entry->bchannel = channel;
+}
+
+/**
+ * Initializes a select entry waiting on a cross-scheduler channel.
+ *
+ * @param entry Entry to initialize
+ * @param channel Channel to wait on
+ * @param mode RN_MODE_IN to wait for something to get, RN_MODE_OUT for room to put
+ */
+void rn_select_mchannel(rn_select_t *entry, rn_mchannel_t *channel, rn_sched_mode_t mode)
+{
+	entry->type = RN_SELECT_MCHANNEL;
+	entry->mode = mode;
+	entry->mchannel = channel;
+}
+
+/**
+ * Looks for the first ready entry.
+ * Registered nodes are ready when an event has been latched for them,
+ * which gets consumed as rn_scheduler_waitfor does: the following IO
+ * may get EAGAIN if the event is stale, and the node is only reported
+ * again on a new event. Nodes which are not registered yet, having
+ * nothing latched, are checked with a non-blocking poll.
+ *
+ * @param entries Entries to check
+ * @param count Number of entries
+ *
+ * @return Index of the first ready entry, or -1 if none is ready
+ */
+static int rn_select_check(rn_select_t *entries, int count)
+{
+	int i;
+	int nbfds;
+	struct pollfd fds[RN_SELECT_MAX];
+
+	nbfds = 0;
+	for (i = 0; i < count; i++) {
+		switch (entries[i].type) {
+		case RN_SELECT_NODE:
+			if (entries[i].node->error != 0) {
+				return i;
+			}
+			if (rn_mode_registered_get(entries[i].node) != RN_MODE_NONE) {
+				if (rn_mode_received(entries[i].node, entries[i].mode)) {
+					rn_mode_received_unset(entries[i].node, entries[i].mode);
+					return i;
+				}
+				break;
+			}
+			fds[nbfds].fd = entries[i].node->fd;
+			fds[nbfds].events = (entries[i].mode == RN_MODE_IN ? POLLIN : POLLOUT);
+			fds[nbfds].revents = 0;
+			nbfds++;
+			break;
+		case RN_SELECT_BCHANNEL:
+			if (rn_bchannel_ready(entries[i].bchannel, entries[i].mode == RN_MODE_IN)) {
+				return i;
+			}
+			break;
+		case RN_SELECT_MCHANNEL:
+			if (rn_mchannel_ready(entries[i].mchannel, entries[i].mode == RN_MODE_IN)) {
+				return i;
+			}
+			break;
+		}
+	}
+	if (nbfds == 0 || poll(fds, nbfds, 0) <= 0) {
+		return -1;
+	}
+	nbfds = 0;
+	for (i = 0; i < count; i++) {
+		if (entries[i].type == RN_SELECT_NODE && rn_mode_registered_get(entries[i].node) == RN_MODE_NONE) {
+			if (fds[nbfds++].revents != 0) {
+				return i;
+			}
+		}
+	}
+	return -1;
+}
+
+/**
+ * Stops watching entries.
+ *
+ * @param entries Entries watched
+ * @param count Number of entries watched
+ * @param selected Index of the entry returned to the caller, if any
+ */
+static void rn_select_unwatch(rn_select_t *entries, int count, int selected)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		switch (entries[i].type) {
+		case RN_SELECT_NODE:
+			rn_scheduler_unwatch(entries[i].node, entries[i].mode);
+			break;
+		case RN_SELECT_BCHANNEL:
+			rn_bchannel_unwatch(entries[i].bchannel, &entries[i].bwaiter, entries[i].mode == RN_MODE_IN, i != selected);
+			break;
+		case RN_SELECT_MCHANNEL:
+			rn_mchannel_unwatch(entries[i].mchannel, &entries[i].mwaiter, entries[i].mode == RN_MODE_IN, i != selected);
+			break;
+		}
+	}
+}
+
+/**
+ * Starts watching entries.
+ * On failure, entries already watched are unwatched.
+ *
+ * @param entries Entries to watch
+ * @param count Number of entries
+ *
+ * @return 0 if entries are watched, 1 if a channel got ready meanwhile, -1 if an error occurs
+ */
+static int rn_select_watch(rn_select_t *entries, int count)
+{
+	int i;
+	int ret;
+
+	ret = 0;
+	for (i = 0; i < count && ret == 0; i++) {
+		switch (entries[i].type) {
+		case RN_SELECT_NODE:
+			ret = rn_scheduler_watch(entries[i].node, entries[i].mode);
+			break;
+		case RN_SELECT_BCHANNEL:
+			rn_bchannel_watch(entries[i].bchannel, &entries[i].bwaiter, entries[i].mode == RN_MODE_IN);
+			break;
+		case RN_SELECT_MCHANNEL:
+			ret = rn_mchannel_watch(entries[i].mchannel, &entries[i].mwaiter, entries[i].mode == RN_MODE_IN);
+			break;
+		}
+	}
+	if (ret != 0) {
+		/* Failed entry is not watched */
+		rn_select_unwatch(entries, i - 1, -1);
+	}
+	return ret;
+}
+
+/**
+ * Suspends the current task until one of the entries is ready, or the timeout expires.
+ * All entries must belong to the given scheduler, except cross-scheduler channels.
+ * Being ready means the next IO or channel operation on the entry should not block.
+ * As with rn_scheduler_waitfor, a node is reported ready once per event: it should be
+ * read or written until it would block before selecting it again.
+ *
+ * @param sched Scheduler running the current task
+ * @param entries Entries to wait on
+ * @param count Number of entries, up to RN_SELECT_MAX
+ * @param timeout Maximum time to wait, in ms, 0 to wait forever
+ *
+ * @return Index of the ready entry, or -1 if an error occurs or the timeout expires (ETIMEDOUT)
+ */
+int rn_select(rn_sched_t *sched, rn_select_t *entries, int count, uint32_t timeout)
+{
+	int i;
+	int ret;
+	int ready;
+	rn_task_t *task;
+	uint64_t deadline;
+
+	XASSERT(sched != NULL, -1);
+	XASSERT(entries != NULL, -1);
+	XASSERT(count > 0 && count <= RN_SELECT_MAX, -1);
+
+	task = rn_task_driver_getcurrent(sched);
+	for (i = 0; i < count; i++) {
+		if (entries[i].type == RN_SELECT_NODE && entries[i].node->sched != sched) {
+			rn_error_set(EINVAL);
+			return -1;
+		}
+	}
+	if (task == &sched->driver.main) {
+		rn_error_set(EINVAL);
+		return -1;
+	}
+	deadline = 0;
+	if (timeout > 0) {
+		deadline = sched->clock + RN_MS_TO_NS(timeout);
+	}
+	for (;;) {
+		ready = rn_select_check(entries, count);
+		if (ready >= 0) {
+			return ready;
+		}
+		if (deadline != 0 && sched->clock >= deadline) {
+			rn_error_set(ETIMEDOUT);
+			return -1;
+		}
+		ret = rn_select_watch(entries, count);
+		if (ret < 0) {
+			return -1;
+		}
+		if (ret == 0) {
+			if (deadline != 0) {
+				rn_task_schedule(task, deadline);
+			}
+			sched->nbpending++;
+			ret = rn_task_release(sched);
+			sched->nbpending--;
+			rn_task_unschedule(task);
+			ready = rn_select_check(entries, count);
+			rn_select_unwatch(entries, count, ready);
+			if (ret != 0) {
+				return -1;
+			}
+			if (ready >= 0) {
+				return ready;
+			}
+		}
+	}
+}
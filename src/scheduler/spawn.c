@@ -10,6 +10,65 @@
 
 #include "rinoo/scheduler/module.h"
 
+static void *rn_spawn_loop(void *arg);
+
+/**
+ * Creates the child scheduler of a spawn slot.
+ * This must be called with the family lock held.
+ *
+ * @param sched Parent scheduler
+ * @param i Slot index, the spawn id being i + 1
+ *
+ * @return Pointer to the child scheduler, or NULL if an error occurs
+ */
+static rn_sched_t *rn_spawn_child(rn_sched_t *sched, int i)
+{
+	rn_sched_t *child;
+
+	child = rn_scheduler();
+	if (child == NULL) {
+		return NULL;
+	}
+	if (rn_scheduler_poller_set(child, sched->poller) != 0) {
+		rn_scheduler_destroy(child);
+		return NULL;
+	}
+	child->id = i + 1;
+	child->clock_id = sched->clock_id;
+	child->busypoll = sched->busypoll;
+	child->looptime = sched->looptime;
+	child->parent = sched;
+	child->steal.enabled = sched->steal.enabled;
+	memset(&sched->spawns.thread[i], 0, sizeof(sched->spawns.thread[i]));
+	sched->spawns.thread[i].sched = child;
+	return child;
+}
+
+/**
+ * Starts the thread of a spawn slot.
+ * Signals handled by the main thread are blocked in spawn threads.
+ *
+ * @param sched Parent scheduler
+ * @param i Slot index
+ *
+ * @return 0 on success, otherwise -1
+ */
+static int rn_spawn_thread(rn_sched_t *sched, int i)
+{
+	int ret;
+	sigset_t oldset;
+	sigset_t newset;
+
+	sigemptyset(&newset);
+	if (sigaddset(&newset, SIGINT) < 0) {
+		return -1;
+	}
+	pthread_sigmask(SIG_BLOCK, &newset, &oldset);
+	ret = pthread_create(&sched->spawns.thread[i].id, NULL, rn_spawn_loop, sched->spawns.thread[i].sched);
+	pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+	return (ret == 0 ? 0 : -1);
+}
+
 /**
  * Spawns a number of children schedulers.
  *
@@ -21,32 +80,29 @@
 int rn_spawn(rn_sched_t *sched, int count)
 {
 	int i;
-	rn_sched_t *child;
 	rn_thread_t *thread;
 
+	/* Running spawns may walk the spawn list to steal tasks */
+	pthread_mutex_lock(&sched->steal.family);
 	if (sched->spawns.count == 0) {
 		thread = calloc(count, sizeof(*thread));
-		if (thread == NULL) {
-			return -1;
-		}
 	} else {
 		thread = realloc(sched->spawns.thread, sizeof(*thread) * (sched->spawns.count + count));
-		if (thread == NULL) {
-			return -1;
-		}
+	}
+	if (thread == NULL) {
+		pthread_mutex_unlock(&sched->steal.family);
+		return -1;
 	}
 	sched->spawns.thread = thread;
 	for (i = sched->spawns.count; i < sched->spawns.count + count; i++) {
-		child = rn_scheduler();
-		if (child == NULL) {
+		if (rn_spawn_child(sched, i) == NULL) {
 			sched->spawns.count = i;
+			pthread_mutex_unlock(&sched->steal.family);
 			return -1;
 		}
-		child->id = i + 1;
-		sched->spawns.thread[i].id = 0;
-		sched->spawns.thread[i].sched = child;
 	}
 	sched->spawns.count = i;
+	pthread_mutex_unlock(&sched->steal.family);
 	return 0;
 }
 
@@ -57,12 +113,263 @@ int rn_spawn(rn_sched_t *sched, int count)
  */
 void rn_spawn_destroy(rn_sched_t *sched)
 {
+	if (sched->spawns.elastic != NULL) {
+		rn_timer_stop(sched, sched->spawns.elastic->timer);
+		free(sched->spawns.elastic);
+		sched->spawns.elastic = NULL;
+	}
 	if (sched->spawns.thread != NULL) {
 		free(sched->spawns.thread);
 	}
 	sched->spawns.count = 0;
 }
 
+/**
+ * Adds a spawn, even while the main scheduler is running.
+ * The spawn is kept alive until it gets retired or its parent stops.
+ * No spawn can be added once the running main scheduler is stopping.
+ * The slot of a retired spawn is reused if any. This must be called
+ * from the main scheduler thread, as the spawn array may move.
+ *
+ * @param sched Main scheduler
+ *
+ * @return Id of the new spawn, or -1 if an error occurs
+ */
+int rn_spawn_add(rn_sched_t *sched)
+{
+	int i;
+
+	XASSERT(sched != NULL, -1);
+	XASSERT(sched->parent == NULL, -1);
+
+	if (sched->running && __atomic_load_n(&sched->stop, __ATOMIC_SEQ_CST)) {
+		/* The main loop is stopping, spawns are being stopped */
+		rn_error_set(ECANCELED);
+		return -1;
+	}
+	pthread_mutex_lock(&sched->steal.family);
+	for (i = 0; i < sched->spawns.count && sched->spawns.thread[i].sched != NULL; i++);
+	pthread_mutex_unlock(&sched->steal.family);
+	if (i == sched->spawns.count) {
+		if (rn_spawn(sched, 1) != 0) {
+			return -1;
+		}
+	} else {
+		if (sched->spawns.thread[i].id != 0) {
+			/* The retired spawn thread is over or about to be */
+			pthread_join(sched->spawns.thread[i].id, NULL);
+		}
+		pthread_mutex_lock(&sched->steal.family);
+		if (rn_spawn_child(sched, i) == NULL) {
+			pthread_mutex_unlock(&sched->steal.family);
+			return -1;
+		}
+		pthread_mutex_unlock(&sched->steal.family);
+	}
+	sched->spawns.thread[i].sched->keepalive = true;
+	pthread_mutex_lock(&sched->steal.family);
+	if (sched->running && __atomic_load_n(&sched->stop, __ATOMIC_SEQ_CST)) {
+		/* Stopped meanwhile, rn_spawn_stop might have missed this spawn */
+		sched->spawns.thread[i].sched->stop = true;
+	}
+	pthread_mutex_unlock(&sched->steal.family);
+	if (sched->running && rn_spawn_thread(sched, i) != 0) {
+		rn_scheduler_destroy(sched->spawns.thread[i].sched);
+		pthread_mutex_lock(&sched->steal.family);
+		memset(&sched->spawns.thread[i], 0, sizeof(sched->spawns.thread[i]));
+		pthread_mutex_unlock(&sched->steal.family);
+		return -1;
+	}
+	return i + 1;
+}
+
+/**
+ * Retires a spawn while the main scheduler keeps running.
+ * The spawn gets drained: its listening sockets stop accepting, tasks
+ * started remotely on it are handed over to the main scheduler, and
+ * it ends once its tasks are over, or after `ms` milliseconds.
+ *
+ * @param sched Main scheduler
+ * @param id Spawn id
+ * @param ms Maximum draining time in milliseconds, 0 for no limit
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_spawn_retire(rn_sched_t *sched, int id, uint32_t ms)
+{
+	rn_sched_t *spawn;
+
+	XASSERT(sched != NULL, -1);
+
+	pthread_mutex_lock(&sched->steal.family);
+	spawn = (id > 0 ? rn_spawn_get(sched, id) : NULL);
+	if (spawn == NULL) {
+		pthread_mutex_unlock(&sched->steal.family);
+		rn_error_set(EINVAL);
+		return -1;
+	}
+	rn_scheduler_drain(spawn, ms);
+	pthread_mutex_unlock(&sched->steal.family);
+	return 0;
+}
+
+/**
+ * Elastic pool timer. Adds a spawn when schedulers are loaded, and
+ * retires one when they are mostly idle. Load is the share of loop
+ * time spent running tasks since the last check, averaged over the
+ * main scheduler and its active spawns, along with run queue depths.
+ *
+ * @param arg Pointer to the main scheduler
+ */
+static void rn_spawn_elastic_check(void *arg)
+{
+	int i;
+	int last;
+	int active;
+	uint64_t run;
+	uint64_t poll;
+	uint64_t load;
+	uint64_t runq;
+	rn_sched_t *cur;
+	rn_thread_t *thread;
+	rn_sched_stats_t stats;
+	rn_sched_t *sched = arg;
+	rn_spawn_elastic_t *elastic = sched->spawns.elastic;
+
+	if (__atomic_load_n(&sched->stop, __ATOMIC_RELAXED)) {
+		return;
+	}
+	rn_stats_get(sched, &stats);
+	run = stats.run_time - elastic->run_time;
+	poll = stats.poll_time - elastic->poll_time;
+	elastic->run_time = stats.run_time;
+	elastic->poll_time = stats.poll_time;
+	load = (run + poll > 0 ? run * 100 / (run + poll) : 0);
+	runq = stats.runq;
+	last = -1;
+	active = 0;
+	pthread_mutex_lock(&sched->steal.family);
+	for (i = 0; i < sched->spawns.count; i++) {
+		thread = &sched->spawns.thread[i];
+		cur = thread->sched;
+		if (cur == NULL || __atomic_load_n(&cur->draining, __ATOMIC_RELAXED)) {
+			continue;
+		}
+		rn_stats_get(cur, &stats);
+		run = stats.run_time - thread->run_time;
+		poll = stats.poll_time - thread->poll_time;
+		thread->run_time = stats.run_time;
+		thread->poll_time = stats.poll_time;
+		load += (run + poll > 0 ? run * 100 / (run + poll) : 0);
+		runq += stats.runq;
+		last = i;
+		active++;
+	}
+	pthread_mutex_unlock(&sched->steal.family);
+	load /= active + 1;
+	runq /= active + 1;
+	if (active < elastic->min || (active < elastic->max && (load >= RN_SPAWN_LOAD_HIGH || runq >= RN_SPAWN_RUNQ_HIGH))) {
+		rn_spawn_add(sched);
+	} else if (active > elastic->min && load <= RN_SPAWN_LOAD_LOW && runq == 0) {
+		rn_spawn_retire(sched, last + 1, RN_SPAWN_RETIRE_TIMEOUT);
+	}
+}
+
+/**
+ * Makes the spawn pool elastic. The load of the main scheduler and
+ * its spawns is checked every `ms` milliseconds, and at most one spawn
+ * is added or retired each time, keeping between `min` and `max` spawns.
+ *
+ * @param sched Main scheduler
+ * @param min Minimum number of spawns
+ * @param max Maximum number of spawns
+ * @param ms Load check interval in milliseconds
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_spawn_elastic(rn_sched_t *sched, int min, int max, uint32_t ms)
+{
+	rn_spawn_elastic_t *elastic;
+
+	XASSERT(sched != NULL, -1);
+	XASSERT(sched->parent == NULL, -1);
+	XASSERT(min >= 0 && min <= max, -1);
+	XASSERT(ms > 0, -1);
+
+	if (sched->spawns.elastic != NULL) {
+		rn_error_set(EBUSY);
+		return -1;
+	}
+	elastic = calloc(1, sizeof(*elastic));
+	if (elastic == NULL) {
+		return -1;
+	}
+	elastic->min = min;
+	elastic->max = max;
+	elastic->timer = rn_timer_start(sched, ms, true, rn_spawn_elastic_check, sched);
+	if (elastic->timer == NULL) {
+		free(elastic);
+		return -1;
+	}
+	sched->spawns.elastic = elastic;
+	/* Load is computed from loop times */
+	rn_stats_looptime(sched, true);
+	return 0;
+}
+
+/**
+ * Pushes a remote message to the least loaded spawn.
+ * Load is the number of live tasks of a spawn, plus the messages
+ * dispatched to it which have not been handled yet. The message
+ * handler must decrement `inflight` of the scheduler handling it.
+ * Retired spawns are skipped, and the main scheduler gets the
+ * message if there is no active spawn.
+ * This function can be called from any scheduler of the family.
+ *
+ * @param sched Pointer to a scheduler of the family
+ * @param msg Pointer to the message to push
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_spawn_dispatch(rn_sched_t *sched, rn_remote_msg_t *msg)
+{
+	int i;
+	int ret;
+	int64_t load;
+	int64_t best;
+	rn_sched_t *cur;
+	rn_sched_t *target;
+
+	XASSERT(sched != NULL, -1);
+	XASSERT(msg != NULL, -1);
+
+	while (sched->parent != NULL) {
+		sched = sched->parent;
+	}
+	best = INT64_MAX;
+	target = sched;
+	/* Holding the family lock prevents spawns from being destroyed */
+	pthread_mutex_lock(&sched->steal.family);
+	for (i = 0; i < sched->spawns.count; i++) {
+		cur = sched->spawns.thread[i].sched;
+		if (cur == NULL || __atomic_load_n(&cur->draining, __ATOMIC_RELAXED)) {
+			continue;
+		}
+		load = __atomic_load_n(&cur->stats.live, __ATOMIC_RELAXED) + __atomic_load_n(&cur->inflight, __ATOMIC_RELAXED);
+		if (load < best) {
+			best = load;
+			target = cur;
+		}
+	}
+	__atomic_add_fetch(&target->inflight, 1, __ATOMIC_RELAXED);
+	ret = rn_remote_push(target, msg);
+	if (ret != 0) {
+		__atomic_sub_fetch(&target->inflight, 1, __ATOMIC_RELAXED);
+	}
+	pthread_mutex_unlock(&sched->steal.family);
+	return ret;
+}
+
 /**
  * Get a scheduler spawn from its id.
  * Id 0 returns sched itself.
@@ -84,32 +391,164 @@ rn_sched_t *rn_spawn_get(rn_sched_t *sched, int id)
 }
 
 /**
- * Main spawn loop. This function should be executed in a thread.
+ * Sets the CPU affinity of a scheduler.
+ * The scheduler thread gets pinned to the given CPU set when its loop starts.
  *
- * @param sched Scheduler running the loop
+ * @param sched Main scheduler
+ * @param id Spawn id, 0 for the main scheduler
+ * @param cpuset CPU set to pin the scheduler to
  *
- * @return NULL
+ * @return 0 on success otherwise -1
  */
-static void *rn_spawn_loop(void *sched)
+int rn_spawn_affinity(rn_sched_t *sched, int id, const cpu_set_t *cpuset)
 {
-	rn_scheduler_loop(sched);
-	rn_scheduler_destroy(sched);
-	return NULL;
+	rn_sched_t *spawn;
+
+	XASSERT(sched != NULL, -1);
+	XASSERT(cpuset != NULL, -1);
+
+	spawn = rn_spawn_get(sched, id);
+	if (spawn == NULL || CPU_COUNT(cpuset) == 0) {
+		rn_error_set(EINVAL);
+		return -1;
+	}
+	spawn->cpuset = *cpuset;
+	spawn->pinned = true;
+	return 0;
 }
 
 /**
- * Signal handler called when killing threads.
- * This will stop the running scheduler.
+ * Pins each spawn to a single CPU.
+ * CPUs are picked round-robin among the CPUs the process can run on,
+ * spawn `n` getting the `n`th one. The main scheduler is left unpinned.
+ *
+ * @param sched Main scheduler
  *
- * @param unused Signal number
+ * @return 0 on success otherwise -1
  */
-static void rn_spawn_handler_stop(int unused(sig))
+int rn_spawn_pin(rn_sched_t *sched)
 {
-	rn_sched_t *sched = rn_scheduler_self();
+	int i;
+	int cpu;
+	int nbcpus;
+	int cpus[CPU_SETSIZE];
+	cpu_set_t cpuset;
+
+	XASSERT(sched != NULL, -1);
 
-	if (sched != NULL) {
-		rn_scheduler_stop(sched);
+	if (sched_getaffinity(0, sizeof(cpuset), &cpuset) != 0) {
+		return -1;
+	}
+	nbcpus = 0;
+	for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+		if (CPU_ISSET(cpu, &cpuset)) {
+			cpus[nbcpus++] = cpu;
+		}
+	}
+	if (nbcpus == 0) {
+		rn_error_set(EINVAL);
+		return -1;
+	}
+	for (i = 1; i <= sched->spawns.count; i++) {
+		CPU_ZERO(&cpuset);
+		CPU_SET(cpus[i % nbcpus], &cpuset);
+		if (rn_spawn_affinity(sched, i, &cpuset) != 0) {
+			return -1;
+		}
 	}
+	return 0;
+}
+
+/**
+ * Moves memory used by a pinned scheduler to its NUMA node.
+ * The whole pages holding the memory are moved, page aligned buffers
+ * should be used not to move unrelated data. This is best effort, and
+ * does nothing if the scheduler is not pinned or its node is unknown.
+ *
+ * @param sched Pointer to the scheduler using the memory
+ * @param ptr Pointer to the memory to move
+ * @param size Memory size
+ */
+void rn_spawn_mbind(rn_sched_t *sched, void *ptr, size_t size)
+{
+	uintptr_t end;
+	uintptr_t start;
+	uintptr_t pagesize;
+	unsigned long nodemask;
+
+	if (!sched->pinned || sched->node < 0 || (size_t) sched->node >= sizeof(nodemask) * 8 || ptr == NULL || size == 0) {
+		return;
+	}
+	nodemask = 1UL << sched->node;
+	pagesize = getpagesize();
+	start = (uintptr_t) ptr & ~(pagesize - 1);
+	end = ((uintptr_t) ptr + size + pagesize - 1) & ~(pagesize - 1);
+	syscall(SYS_mbind, start, end - start, MPOL_PREFERRED, &nodemask, sizeof(nodemask) * 8, MPOL_MF_MOVE);
+}
+
+/**
+ * Binds the calling thread to a scheduler CPU set, if any, and
+ * records the CPU and NUMA node the scheduler runs on.
+ * Once pinned, the scheduler memory is moved to the local NUMA node
+ * and the thread allocates from it. Memory placement is best effort.
+ *
+ * @param sched Scheduler run by the calling thread
+ *
+ * @return 0 on success otherwise -1
+ */
+int rn_spawn_bind(rn_sched_t *sched)
+{
+	unsigned int cpu;
+	unsigned int node;
+	unsigned long nodemask;
+
+	XASSERT(sched != NULL, -1);
+
+	if (sched->pinned && pthread_setaffinity_np(pthread_self(), sizeof(sched->cpuset), &sched->cpuset) != 0) {
+		return -1;
+	}
+	if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) {
+		/* Mapping is unknown, this is not an error */
+		return 0;
+	}
+	sched->cpu = cpu;
+	sched->node = node;
+	if (sched->pinned && node < sizeof(nodemask) * 8) {
+		nodemask = 1UL << node;
+		syscall(SYS_set_mempolicy, MPOL_PREFERRED, &nodemask, sizeof(nodemask) * 8);
+		rn_spawn_mbind(sched, sched, sizeof(*sched));
+		if (sched->poller == &rn_poller_epoll) {
+			/* Allocated by the parent thread, on its node */
+			rn_spawn_mbind(sched, sched->epoll.events, sizeof(*sched->epoll.events) * sched->epoll.nbevents);
+		}
+		/* Refill the task pool from the local node */
+		rn_task_stack_set(sched, sched->driver.pool.stack_size);
+	}
+	return 0;
+}
+
+/**
+ * Main spawn loop. This function should be executed in a thread.
+ *
+ * @param sched Scheduler running the loop
+ *
+ * @return NULL
+ */
+static void *rn_spawn_loop(void *arg)
+{
+	rn_sched_t *sched = arg;
+	rn_sched_t *parent = sched->parent;
+
+	rn_spawn_bind(sched);
+	rn_scheduler_loop(sched);
+	/* Leave the spawn list first, the parent can't wake up a destroyed spawn */
+	pthread_mutex_lock(&parent->steal.family);
+	if (parent->spawns.thread[sched->id - 1].sched == sched) {
+		parent->spawns.thread[sched->id - 1].sched = NULL;
+	}
+	pthread_mutex_unlock(&parent->steal.family);
+	rn_scheduler_destroy(sched);
+	return NULL;
 }
 
 /**
@@ -122,29 +561,24 @@ static void rn_spawn_handler_stop(int unused(sig))
 int rn_spawn_start(rn_sched_t *sched)
 {
 	int i;
-	sigset_t oldset;
-	sigset_t newset;
 
-	sigemptyset(&newset);
-	if (sigaddset(&newset, SIGINT) < 0) {
-		return -1;
-	}
-	if (sigaction(SIGUSR2, &(struct sigaction){ .sa_handler = rn_spawn_handler_stop }, NULL) != 0) {
+	if (rn_spawn_bind(sched) != 0) {
 		return -1;
 	}
-	pthread_sigmask(SIG_BLOCK, &newset, &oldset);
 	for (i = 0; i < sched->spawns.count; i++) {
-		if (pthread_create(&sched->spawns.thread[i].id, NULL, rn_spawn_loop, sched->spawns.thread[i].sched) != 0) {
-			pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+		if (sched->spawns.thread[i].sched != NULL && sched->spawns.thread[i].id == 0 && rn_spawn_thread(sched, i) != 0) {
 			return -1;
 		}
 	}
-	pthread_sigmask(SIG_SETMASK, &oldset, NULL);
 	return 0;
 }
 
 /**
  * Stops all schedule spawns.
+ * Each spawn is woken up through its remote queue eventfd, so that
+ * a spawn blocked in its poller notices the stop immediately.
+ * A spawn leaves the spawn list before being destroyed, the family
+ * lock keeps it alive meanwhile.
  *
  * @param sched Main scheduler
  */
@@ -152,12 +586,65 @@ void rn_spawn_stop(rn_sched_t *sched)
 {
 	int i;
 
+	if (sched->spawns.count == 0) {
+		return;
+	}
+	pthread_mutex_lock(&sched->steal.family);
+	for (i = 0; i < sched->spawns.count; i++) {
+		if (sched->spawns.thread[i].sched != NULL) {
+			rn_scheduler_stop(sched->spawns.thread[i].sched);
+		}
+	}
+	pthread_mutex_unlock(&sched->steal.family);
+}
+
+/**
+ * Drains all scheduler spawns.
+ *
+ * @param sched Main scheduler
+ * @param ms Maximum draining time in milliseconds, 0 for no limit
+ */
+void rn_spawn_drain(rn_sched_t *sched, uint32_t ms)
+{
+	int i;
+
+	if (sched->spawns.count == 0) {
+		return;
+	}
+	pthread_mutex_lock(&sched->steal.family);
 	for (i = 0; i < sched->spawns.count; i++) {
-		if (sched->spawns.thread[i].id != 0) {
-			sched->spawns.thread[i].sched = NULL;
-			pthread_kill(sched->spawns.thread[i].id, SIGUSR2);
+		if (sched->spawns.thread[i].sched != NULL) {
+			rn_scheduler_drain(sched->spawns.thread[i].sched, ms);
+		}
+	}
+	pthread_mutex_unlock(&sched->steal.family);
+}
+
+/**
+ * Drains spawns kept alive once the main scheduler loop ended on its own.
+ * Such spawns would otherwise wait for a stop which never comes.
+ * The main scheduler is flagged as draining, so retired spawns keep
+ * their tasks instead of handing them over.
+ *
+ * @param sched Main scheduler
+ */
+void rn_spawn_release(rn_sched_t *sched)
+{
+	int i;
+	rn_sched_t *spawn;
+
+	if (sched->spawns.count == 0) {
+		return;
+	}
+	__atomic_store_n(&sched->draining, true, __ATOMIC_SEQ_CST);
+	pthread_mutex_lock(&sched->steal.family);
+	for (i = 0; i < sched->spawns.count; i++) {
+		spawn = sched->spawns.thread[i].sched;
+		if (spawn != NULL && __atomic_load_n(&spawn->keepalive, __ATOMIC_RELAXED)) {
+			rn_scheduler_drain(spawn, 0);
 		}
 	}
+	pthread_mutex_unlock(&sched->steal.family);
 }
 
 /**
@@ -172,6 +659,7 @@ void rn_spawn_join(rn_sched_t *sched)
 	for (i = 0; i < sched->spawns.count; i++) {
 		if (sched->spawns.thread[i].id != 0) {
 			pthread_join(sched->spawns.thread[i].id, NULL);
+			sched->spawns.thread[i].id = 0;
 		}
 	}
 }
@@ -0,0 +1,192 @@
+/**
+ * @file   stats.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Scheduler statistics functions
+ *
+ *
+ */
+
+#include "rinoo/scheduler/module.h"
+
+/**
+ * Gets statistics of a scheduler.
+ * This function can be called from any thread.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param stats Pointer to the statistics structure to fill
+ */
+void rn_stats_get(rn_sched_t *sched, rn_sched_stats_t *stats)
+{
+	XASSERTN(sched != NULL);
+	XASSERTN(stats != NULL);
+
+	stats->switches = __atomic_load_n(&sched->stats.switches, __ATOMIC_RELAXED);
+	stats->created = __atomic_load_n(&sched->stats.created, __ATOMIC_RELAXED);
+	stats->destroyed = __atomic_load_n(&sched->stats.destroyed, __ATOMIC_RELAXED);
+	stats->live = __atomic_load_n(&sched->stats.live, __ATOMIC_RELAXED);
+	stats->pending = __atomic_load_n(&sched->nbpending, __ATOMIC_RELAXED);
+	stats->runq = __atomic_load_n(&sched->driver.runq.size, __ATOMIC_RELAXED);
+	stats->wakeups = __atomic_load_n(&sched->stats.wakeups, __ATOMIC_RELAXED);
+	stats->events = __atomic_load_n(&sched->stats.events, __ATOMIC_RELAXED);
+	stats->timers = __atomic_load_n(&sched->stats.timers, __ATOMIC_RELAXED);
+	stats->yields = __atomic_load_n(&sched->stats.yields, __ATOMIC_RELAXED);
+	stats->spins = __atomic_load_n(&sched->stats.spins, __ATOMIC_RELAXED);
+	stats->waits = __atomic_load_n(&sched->stats.waits, __ATOMIC_RELAXED);
+	stats->poll_time = __atomic_load_n(&sched->stats.poll_time, __ATOMIC_RELAXED);
+	stats->run_time = __atomic_load_n(&sched->stats.run_time, __ATOMIC_RELAXED);
+}
+
+/**
+ * Gets statistics of a scheduler and all its spawns at once.
+ * stats[0] is filled with the scheduler statistics, and stats[n]
+ * with the statistics of spawn n. Spawns which are over are zeroed.
+ *
+ * @param sched Pointer to the parent scheduler
+ * @param stats Array of statistics structures to fill
+ * @param count Number of entries in the array
+ *
+ * @return Number of entries filled
+ */
+int rn_stats_snapshot(rn_sched_t *sched, rn_sched_stats_t *stats, int count)
+{
+	int i;
+	rn_sched_t *cur;
+
+	XASSERT(sched != NULL, -1);
+	XASSERT(stats != NULL, -1);
+
+	/* Holding the family lock prevents spawns from being destroyed */
+	pthread_mutex_lock(&sched->steal.family);
+	for (i = 0; i < count && i <= sched->spawns.count; i++) {
+		cur = rn_spawn_get(sched, i);
+		if (cur == NULL) {
+			memset(&stats[i], 0, sizeof(stats[i]));
+			continue;
+		}
+		rn_stats_get(cur, &stats[i]);
+	}
+	pthread_mutex_unlock(&sched->steal.family);
+	return i;
+}
+
+/**
+ * Enables or disables loop lag and task run time histograms of a scheduler.
+ * Histograms are reset when enabled.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param enabled Whether histograms should be recorded
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_stats_histograms(rn_sched_t *sched, bool enabled)
+{
+	XASSERT(sched != NULL, -1);
+
+	if (!enabled) {
+		free(sched->hist);
+		sched->hist = NULL;
+		return 0;
+	}
+	if (sched->hist == NULL) {
+		sched->hist = malloc(sizeof(*sched->hist));
+		if (sched->hist == NULL) {
+			return -1;
+		}
+	}
+	rn_histogram(&sched->hist->lag);
+	rn_histogram(&sched->hist->runtime);
+	return 0;
+}
+
+/**
+ * Sets a callback to be called when a task runs for too long
+ * before giving control back to its scheduler.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param threshold Run time in ns above which the callback is called
+ * @param callback Function to call with the slow task and its run time, NULL to disable
+ */
+void rn_stats_slowtask(rn_sched_t *sched, uint64_t threshold, rn_stats_slow_t callback)
+{
+	XASSERTN(sched != NULL);
+
+	sched->slow_threshold = threshold;
+	sched->slow_callback = callback;
+}
+
+/**
+ * Enables or disables per task run time accounting.
+ * When enabled, the time each task spends running, from the moment it
+ * is resumed until it gives control back, is added up in task->cputime.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param enabled Whether task run time should be accounted
+ */
+void rn_stats_cputime(rn_sched_t *sched, bool enabled)
+{
+	XASSERTN(sched != NULL);
+
+	sched->cputime = enabled;
+}
+
+/**
+ * Enables or disables loop run time and poll time accounting of a
+ * scheduler and its spawns. This costs a clock read per loop iteration,
+ * before polling.
+ *
+ * @param sched Pointer to the main scheduler
+ * @param enabled Whether loop times should be accounted
+ */
+void rn_stats_looptime(rn_sched_t *sched, bool enabled)
+{
+	int i;
+
+	XASSERTN(sched != NULL);
+
+	pthread_mutex_lock(&sched->steal.family);
+	sched->looptime = enabled;
+	for (i = 0; i < sched->spawns.count; i++) {
+		if (sched->spawns.thread[i].sched != NULL) {
+			sched->spawns.thread[i].sched->looptime = enabled;
+		}
+	}
+	pthread_mutex_unlock(&sched->steal.family);
+}
+
+/**
+ * Records how late a timer has fired.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param lag Time elapsed since the timer deadline, in ns
+ */
+void rn_stats_lag(rn_sched_t *sched, uint64_t lag)
+{
+	if (sched->hist != NULL) {
+		rn_histogram_add(&sched->hist->lag, lag);
+	}
+}
+
+/**
+ * Records the time a task has been running.
+ * The slow task callback is called if the run time is above the threshold.
+ *
+ * @param task Pointer to the task which has been running
+ * @param duration Run time in ns
+ */
+void rn_stats_runtime(rn_task_t *task, uint64_t duration)
+{
+	rn_sched_t *sched;
+
+	sched = task->sched;
+	if (sched->cputime) {
+		task->cputime += duration;
+	}
+	if (sched->hist != NULL) {
+		rn_histogram_add(&sched->hist->runtime, duration);
+	}
+	if (sched->slow_callback != NULL && duration >= sched->slow_threshold) {
+		sched->slow_callback(task, duration);
+	}
+}
@@ -0,0 +1,291 @@
+/**
+ * @file   steal.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Work stealing functions
+ *
+ *
+ */
+
+#include "rinoo/scheduler/module.h"
+
+/**
+ * Gets the root scheduler of a scheduler family.
+ *
+ * @param sched Pointer to a scheduler of the family
+ *
+ * @return Pointer to the root scheduler
+ */
+static inline rn_sched_t *rn_steal_root(rn_sched_t *sched)
+{
+	return (sched->parent != NULL ? sched->parent : sched);
+}
+
+/**
+ * Pops a stealable task from a scheduler queue.
+ *
+ * @param sched Pointer to the scheduler owning the queue
+ *
+ * @return Pointer to a task, or NULL if the queue is empty
+ */
+static rn_task_t *rn_steal_pop(rn_sched_t *sched)
+{
+	rn_list_node_t *node;
+
+	if (__atomic_load_n(&sched->steal.tasks.size, __ATOMIC_RELAXED) == 0) {
+		return NULL;
+	}
+	pthread_mutex_lock(&sched->steal.lock);
+	node = rn_list_pop(&sched->steal.tasks);
+	pthread_mutex_unlock(&sched->steal.lock);
+	if (node == NULL) {
+		return NULL;
+	}
+	__atomic_sub_fetch(&rn_steal_root(sched)->steal.nbtasks, 1, __ATOMIC_SEQ_CST);
+	return container_of(node, rn_task_t, run_node);
+}
+
+/**
+ * Moves a stolen task to a new scheduler.
+ * The task has never run, so its context only needs to be rebuilt
+ * to return to the new scheduler once the task is over.
+ *
+ * @param sched Pointer to the scheduler adopting the task
+ * @param task Pointer to the stolen task
+ */
+static void rn_steal_adopt(rn_sched_t *sched, rn_task_t *task)
+{
+	__atomic_sub_fetch(&task->sched->stats.live, 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&sched->stats.live, 1, __ATOMIC_RELAXED);
+	task->sched = sched;
+	task->context.link = &sched->driver.main.context;
+	fcontext(&task->context, task->function, task->arg);
+}
+
+/**
+ * Initializes work stealing in a scheduler.
+ * Work stealing is disabled by default.
+ *
+ * @param sched Pointer to the scheduler to use
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_steal_init(rn_sched_t *sched)
+{
+	XASSERT(sched != NULL, -1);
+
+	sched->steal.enabled = false;
+	sched->steal.idle = false;
+	sched->steal.nbidle = 0;
+	sched->steal.nbtasks = 0;
+	memset(&sched->steal.stats, 0, sizeof(sched->steal.stats));
+	if (rn_list(&sched->steal.tasks, NULL) != 0) {
+		return -1;
+	}
+	if (pthread_mutex_init(&sched->steal.lock, NULL) != 0) {
+		return -1;
+	}
+	if (pthread_mutex_init(&sched->steal.family, NULL) != 0) {
+		pthread_mutex_destroy(&sched->steal.lock);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Destroys work stealing in a scheduler.
+ * The scheduler leaves its family so that it can't be stolen from
+ * anymore, and its remaining stealable tasks are moved to its run queue.
+ *
+ * @param sched Pointer to the scheduler to use
+ */
+void rn_steal_destroy(rn_sched_t *sched)
+{
+	rn_task_t *task;
+	rn_sched_t *root;
+
+	XASSERTN(sched != NULL);
+
+	root = rn_steal_root(sched);
+	if (root != sched) {
+		pthread_mutex_lock(&root->steal.family);
+		if (sched->id > 0 && sched->id <= root->spawns.count && root->spawns.thread[sched->id - 1].sched == sched) {
+			root->spawns.thread[sched->id - 1].sched = NULL;
+		}
+		pthread_mutex_unlock(&root->steal.family);
+	}
+	while ((task = rn_steal_pop(sched)) != NULL) {
+		rn_task_schedule(task, 0);
+	}
+	pthread_mutex_destroy(&sched->steal.lock);
+	pthread_mutex_destroy(&sched->steal.family);
+}
+
+/**
+ * Enables or disables work stealing in a scheduler family.
+ * This applies to the scheduler, its parent and all its spawns.
+ *
+ * @param sched Pointer to a scheduler of the family
+ * @param enabled Whether spawns can steal tasks from each other
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_steal_set(rn_sched_t *sched, bool enabled)
+{
+	int i;
+	rn_sched_t *root;
+	rn_sched_t *cur;
+
+	XASSERT(sched != NULL, -1);
+
+	root = rn_steal_root(sched);
+	pthread_mutex_lock(&root->steal.family);
+	for (i = 0; i <= root->spawns.count; i++) {
+		cur = rn_spawn_get(root, i);
+		if (cur != NULL) {
+			cur->steal.enabled = enabled;
+		}
+	}
+	pthread_mutex_unlock(&root->steal.family);
+	return 0;
+}
+
+/**
+ * Gets work stealing statistics of a scheduler.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param stats Pointer to the statistics structure to fill
+ */
+void rn_steal_stats(rn_sched_t *sched, rn_steal_stats_t *stats)
+{
+	XASSERTN(sched != NULL);
+	XASSERTN(stats != NULL);
+
+	stats->stolen = __atomic_load_n(&sched->steal.stats.stolen, __ATOMIC_RELAXED);
+	stats->given = __atomic_load_n(&sched->steal.stats.given, __ATOMIC_RELAXED);
+	stats->failed = __atomic_load_n(&sched->steal.stats.failed, __ATOMIC_RELAXED);
+}
+
+/**
+ * Queues a stealable task and wakes up an idle scheduler of the family, if any.
+ *
+ * @param sched Pointer to the scheduler owning the task
+ * @param task Pointer to a task which has not been started yet
+ */
+void rn_steal_push(rn_sched_t *sched, rn_task_t *task)
+{
+	int i;
+	bool idle;
+	rn_sched_t *root;
+	rn_sched_t *cur;
+
+	root = rn_steal_root(sched);
+	pthread_mutex_lock(&sched->steal.lock);
+	rn_list_append(&sched->steal.tasks, &task->run_node);
+	pthread_mutex_unlock(&sched->steal.lock);
+	__atomic_add_fetch(&root->steal.nbtasks, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&root->steal.nbidle, __ATOMIC_SEQ_CST) == 0) {
+		return;
+	}
+	pthread_mutex_lock(&root->steal.family);
+	for (i = 0; i <= root->spawns.count; i++) {
+		cur = rn_spawn_get(root, i);
+		if (cur == NULL || cur == sched) {
+			continue;
+		}
+		idle = true;
+		if (__atomic_compare_exchange_n(&cur->steal.idle, &idle, false, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+			__atomic_sub_fetch(&root->steal.nbidle, 1, __ATOMIC_SEQ_CST);
+			rn_remote_wakeup(cur);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&root->steal.family);
+}
+
+/**
+ * Schedules a stealable task on a scheduler.
+ * A scheduler first runs its own stealable tasks. If it has nothing
+ * to run, it steals a task from another scheduler of its family.
+ *
+ * @param sched Pointer to the scheduler to use
+ *
+ * @return 1 if a task has been scheduled, otherwise 0
+ */
+int rn_steal_run(rn_sched_t *sched)
+{
+	int i;
+	int count;
+	rn_task_t *task;
+	rn_sched_t *root;
+	rn_sched_t *victim;
+
+	task = rn_steal_pop(sched);
+	if (task == NULL) {
+		root = rn_steal_root(sched);
+		if (sched->steal.enabled == false || rn_list_size(&sched->driver.runq) > 0 || __atomic_load_n(&root->steal.nbtasks, __ATOMIC_SEQ_CST) == 0) {
+			return 0;
+		}
+		pthread_mutex_lock(&root->steal.family);
+		count = root->spawns.count;
+		for (i = 1; i <= count && task == NULL; i++) {
+			victim = rn_spawn_get(root, (sched->id + i) % (count + 1));
+			if (victim == NULL || victim == sched) {
+				continue;
+			}
+			task = rn_steal_pop(victim);
+			if (task != NULL) {
+				__atomic_add_fetch(&victim->steal.stats.given, 1, __ATOMIC_RELAXED);
+			}
+		}
+		pthread_mutex_unlock(&root->steal.family);
+		if (task == NULL) {
+			__atomic_add_fetch(&sched->steal.stats.failed, 1, __ATOMIC_RELAXED);
+			return 0;
+		}
+		__atomic_add_fetch(&sched->steal.stats.stolen, 1, __ATOMIC_RELAXED);
+		rn_steal_adopt(sched, task);
+	}
+	rn_task_schedule(task, 0);
+	return 1;
+}
+
+/**
+ * Checks whether a scheduler has stealable tasks to run.
+ *
+ * @param sched Pointer to the scheduler to use
+ *
+ * @return true if the scheduler or, when stealing is enabled, its family has stealable tasks
+ */
+bool rn_steal_pending(rn_sched_t *sched)
+{
+	if (__atomic_load_n(&sched->steal.tasks.size, __ATOMIC_RELAXED) > 0) {
+		return true;
+	}
+	return (sched->steal.enabled && __atomic_load_n(&rn_steal_root(sched)->steal.nbtasks, __ATOMIC_SEQ_CST) > 0);
+}
+
+/**
+ * Marks a scheduler as idle, or busy.
+ * Idle schedulers get woken up when a stealable task is queued.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param idle Whether the scheduler is about to block
+ */
+void rn_steal_idle(rn_sched_t *sched, bool idle)
+{
+	bool expected;
+	rn_sched_t *root;
+
+	root = rn_steal_root(sched);
+	if (idle) {
+		__atomic_store_n(&sched->steal.idle, true, __ATOMIC_SEQ_CST);
+		__atomic_add_fetch(&root->steal.nbidle, 1, __ATOMIC_SEQ_CST);
+		return;
+	}
+	expected = true;
+	if (__atomic_compare_exchange_n(&sched->steal.idle, &expected, false, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+		__atomic_sub_fetch(&root->steal.nbidle, 1, __ATOMIC_SEQ_CST);
+	}
+}
@@ -0,0 +1,583 @@
+/**
+ * @file   sync.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Task synchronization functions
+ *
+ *
+ */
+
+#include "rinoo/scheduler/module.h"
+
+/**
+ * Remote message handler scheduling a woken task on its own scheduler.
+ *
+ * @param sched Pointer to the scheduler running the task
+ * @param msg Pointer to the waiter message
+ */
+static void rn_sync_resume(rn_sched_t *unused(sched), rn_remote_msg_t *msg)
+{
+	rn_sync_waiter_t *waiter;
+
+	waiter = container_of(msg, rn_sync_waiter_t, msg);
+	waiter->delivered = true;
+	rn_task_schedule(waiter->task, 0);
+}
+
+/**
+ * Initializes a waiter for the current task.
+ *
+ * @param waiter Pointer to the waiter to initialize
+ *
+ * @return 0 on success, or -1 if the current task can't wait
+ */
+static int rn_sync_waiter(rn_sync_waiter_t *waiter)
+{
+	waiter->task = rn_task_self();
+	if (waiter->task == NULL || waiter->task == &waiter->task->sched->driver.main) {
+		rn_error_set(EINVAL);
+		return -1;
+	}
+	waiter->woken = false;
+	waiter->delivered = false;
+	waiter->msg.handler = rn_sync_resume;
+	return 0;
+}
+
+/**
+ * Pops the first waiter of a list and marks it as woken.
+ * The list lock must be held.
+ *
+ * @param waiters List of waiting tasks
+ *
+ * @return Pointer to the waiter, or NULL if the list is empty
+ */
+static rn_sync_waiter_t *rn_sync_pop(rn_list_t *waiters)
+{
+	rn_list_node_t *node;
+	rn_sync_waiter_t *waiter;
+
+	node = rn_list_pop(waiters);
+	if (node == NULL) {
+		return NULL;
+	}
+	waiter = container_of(node, rn_sync_waiter_t, node);
+	waiter->woken = true;
+	return waiter;
+}
+
+/**
+ * Wakes up a waiter. The waiter must have been popped from its list,
+ * and the list lock must be released.
+ *
+ * @param waiter Pointer to the waiter to wake up
+ */
+static void rn_sync_notify(rn_sync_waiter_t *waiter)
+{
+	if (waiter->task->sched == rn_scheduler_self()) {
+		waiter->delivered = true;
+		rn_task_schedule(waiter->task, 0);
+	} else {
+		rn_remote_push(waiter->task->sched, &waiter->msg);
+	}
+}
+
+/**
+ * Wakes up all waiters of a list.
+ *
+ * @param waiters List of waiting tasks
+ * @param lock Lock protecting the list, it must be held and gets released
+ */
+static void rn_sync_wake_all(rn_list_t *waiters, pthread_mutex_t *lock)
+{
+	rn_list_t woken;
+	rn_list_node_t *node;
+	rn_sync_waiter_t *waiter;
+
+	rn_list(&woken, NULL);
+	while ((waiter = rn_sync_pop(waiters)) != NULL) {
+		rn_list_append(&woken, &waiter->node);
+	}
+	pthread_mutex_unlock(lock);
+	while ((node = rn_list_pop(&woken)) != NULL) {
+		rn_sync_notify(container_of(node, rn_sync_waiter_t, node));
+	}
+}
+
+/**
+ * Suspends the current task until its waiter gets woken up.
+ * The waiter must have been added to the list, and the list lock released.
+ * Once woken, the task stays suspended until the wakeup is delivered, even
+ * if its scheduler stops, as the waiter message lives in the task stack.
+ * If the scheduler stops, -1 is returned even though the waiter may have
+ * been woken, which callers must check to give back what they were handed.
+ *
+ * @param waiters List of waiting tasks
+ * @param lock Lock protecting the list
+ * @param waiter Waiter of the current task
+ * @param deadline Maximum time to wait, on the scheduler clock, 0 to wait forever
+ *
+ * @return 0 if the waiter has been woken up, or -1 on timeout or if the scheduler stops
+ */
+static int rn_sync_park(rn_list_t *waiters, pthread_mutex_t *lock, rn_sync_waiter_t *waiter, uint64_t deadline)
+{
+	int ret;
+	bool woken;
+	rn_sched_t *sched;
+
+	sched = waiter->task->sched;
+	sched->nbpending++;
+	if (deadline != 0) {
+		rn_task_schedule(waiter->task, deadline);
+	}
+	ret = rn_task_release(sched);
+	rn_task_unschedule(waiter->task);
+	pthread_mutex_lock(lock);
+	woken = waiter->woken;
+	if (!woken) {
+		rn_list_remove(waiters, &waiter->node);
+	}
+	pthread_mutex_unlock(lock);
+	if (!woken) {
+		sched->nbpending--;
+		if (ret == 0) {
+			rn_error_set(ETIMEDOUT);
+		}
+		return -1;
+	}
+	/* The waiter can't be released before its wakeup is delivered */
+	while (!waiter->delivered) {
+		if (rn_task_release(sched) != 0) {
+			ret = -1;
+		}
+	}
+	rn_task_unschedule(waiter->task);
+	sched->nbpending--;
+	if (ret != 0) {
+		rn_error_set(ECANCELED);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Initializes a task mutex.
+ *
+ * @param mutex Pointer to the mutex to initialize
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_mutex(rn_mutex_t *mutex)
+{
+	XASSERT(mutex != NULL, -1);
+
+	mutex->locked = false;
+	rn_list(&mutex->waiters, NULL);
+	return (pthread_mutex_init(&mutex->lock, NULL) == 0 ? 0 : -1);
+}
+
+/**
+ * Destroys a task mutex. No task must be waiting on it.
+ *
+ * @param mutex Pointer to the mutex to destroy
+ */
+void rn_mutex_destroy(rn_mutex_t *mutex)
+{
+	XASSERTN(mutex != NULL);
+
+	pthread_mutex_destroy(&mutex->lock);
+}
+
+/**
+ * Locks a task mutex. The current task is suspended while the mutex
+ * is locked. Ownership is handed over to waiting tasks in order.
+ *
+ * @param mutex Pointer to the mutex to lock
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_mutex_lock(rn_mutex_t *mutex)
+{
+	rn_sync_waiter_t waiter;
+
+	XASSERT(mutex != NULL, -1);
+
+	pthread_mutex_lock(&mutex->lock);
+	if (!mutex->locked) {
+		mutex->locked = true;
+		pthread_mutex_unlock(&mutex->lock);
+		return 0;
+	}
+	if (rn_sync_waiter(&waiter) != 0) {
+		pthread_mutex_unlock(&mutex->lock);
+		return -1;
+	}
+	rn_list_append(&mutex->waiters, &waiter.node);
+	pthread_mutex_unlock(&mutex->lock);
+	if (rn_sync_park(&mutex->waiters, &mutex->lock, &waiter, 0) != 0) {
+		if (waiter.woken) {
+			/* Ownership has been handed over meanwhile */
+			rn_mutex_unlock(mutex);
+		}
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Locks a task mutex without waiting.
+ *
+ * @param mutex Pointer to the mutex to lock
+ *
+ * @return 0 on success, or -1 if the mutex is already locked
+ */
+int rn_mutex_trylock(rn_mutex_t *mutex)
+{
+	int ret;
+
+	XASSERT(mutex != NULL, -1);
+
+	ret = -1;
+	pthread_mutex_lock(&mutex->lock);
+	if (!mutex->locked) {
+		mutex->locked = true;
+		ret = 0;
+	}
+	pthread_mutex_unlock(&mutex->lock);
+	if (ret != 0) {
+		rn_error_set(EBUSY);
+	}
+	return ret;
+}
+
+/**
+ * Unlocks a task mutex. The first waiting task, if any, gets the mutex.
+ *
+ * @param mutex Pointer to the mutex to unlock
+ */
+void rn_mutex_unlock(rn_mutex_t *mutex)
+{
+	rn_sync_waiter_t *waiter;
+
+	XASSERTN(mutex != NULL);
+
+	pthread_mutex_lock(&mutex->lock);
+	waiter = rn_sync_pop(&mutex->waiters);
+	if (waiter == NULL) {
+		mutex->locked = false;
+	}
+	pthread_mutex_unlock(&mutex->lock);
+	if (waiter != NULL) {
+		rn_sync_notify(waiter);
+	}
+}
+
+/**
+ * Initializes a task semaphore.
+ *
+ * @param sem Pointer to the semaphore to initialize
+ * @param value Initial value
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_sem(rn_sem_t *sem, uint32_t value)
+{
+	XASSERT(sem != NULL, -1);
+
+	sem->value = value;
+	rn_list(&sem->waiters, NULL);
+	return (pthread_mutex_init(&sem->lock, NULL) == 0 ? 0 : -1);
+}
+
+/**
+ * Destroys a task semaphore. No task must be waiting on it.
+ *
+ * @param sem Pointer to the semaphore to destroy
+ */
+void rn_sem_destroy(rn_sem_t *sem)
+{
+	XASSERTN(sem != NULL);
+
+	pthread_mutex_destroy(&sem->lock);
+}
+
+/**
+ * Decrements a task semaphore. The current task is suspended
+ * while the semaphore value is 0.
+ *
+ * @param sem Pointer to the semaphore to use
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_sem_wait(rn_sem_t *sem)
+{
+	rn_sync_waiter_t waiter;
+
+	XASSERT(sem != NULL, -1);
+
+	pthread_mutex_lock(&sem->lock);
+	if (sem->value > 0) {
+		sem->value--;
+		pthread_mutex_unlock(&sem->lock);
+		return 0;
+	}
+	if (rn_sync_waiter(&waiter) != 0) {
+		pthread_mutex_unlock(&sem->lock);
+		return -1;
+	}
+	rn_list_append(&sem->waiters, &waiter.node);
+	pthread_mutex_unlock(&sem->lock);
+	if (rn_sync_park(&sem->waiters, &sem->lock, &waiter, 0) != 0) {
+		if (waiter.woken) {
+			/* A post has been handed over meanwhile */
+			rn_sem_post(sem);
+		}
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Decrements a task semaphore without waiting.
+ *
+ * @param sem Pointer to the semaphore to use
+ *
+ * @return 0 on success, or -1 if the semaphore value is 0
+ */
+int rn_sem_trywait(rn_sem_t *sem)
+{
+	int ret;
+
+	XASSERT(sem != NULL, -1);
+
+	ret = -1;
+	pthread_mutex_lock(&sem->lock);
+	if (sem->value > 0) {
+		sem->value--;
+		ret = 0;
+	}
+	pthread_mutex_unlock(&sem->lock);
+	if (ret != 0) {
+		rn_error_set(EAGAIN);
+	}
+	return ret;
+}
+
+/**
+ * Increments a task semaphore. If a task is waiting,
+ * the increment is handed over to it.
+ *
+ * @param sem Pointer to the semaphore to use
+ */
+void rn_sem_post(rn_sem_t *sem)
+{
+	rn_sync_waiter_t *waiter;
+
+	XASSERTN(sem != NULL);
+
+	pthread_mutex_lock(&sem->lock);
+	waiter = rn_sync_pop(&sem->waiters);
+	if (waiter == NULL) {
+		sem->value++;
+	}
+	pthread_mutex_unlock(&sem->lock);
+	if (waiter != NULL) {
+		rn_sync_notify(waiter);
+	}
+}
+
+/**
+ * Initializes a task condition.
+ *
+ * @param cond Pointer to the condition to initialize
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_cond(rn_cond_t *cond)
+{
+	XASSERT(cond != NULL, -1);
+
+	rn_list(&cond->waiters, NULL);
+	return (pthread_mutex_init(&cond->lock, NULL) == 0 ? 0 : -1);
+}
+
+/**
+ * Destroys a task condition. No task must be waiting on it.
+ *
+ * @param cond Pointer to the condition to destroy
+ */
+void rn_cond_destroy(rn_cond_t *cond)
+{
+	XASSERTN(cond != NULL);
+
+	pthread_mutex_destroy(&cond->lock);
+}
+
+/**
+ * Waits on a task condition with a maximum waiting time.
+ * The mutex gets unlocked while waiting, and locked again before returning.
+ *
+ * @param cond Pointer to the condition to wait on
+ * @param mutex Pointer to the locked mutex protecting the condition
+ * @param ms Maximum time to wait in milliseconds, 0 to wait forever
+ *
+ * @return 0 if the condition has been signaled, or -1 if an error occurs or the timeout expires (ETIMEDOUT)
+ */
+int rn_cond_timedwait(rn_cond_t *cond, rn_mutex_t *mutex, uint32_t ms)
+{
+	int ret;
+	uint64_t deadline;
+	rn_sync_waiter_t waiter;
+
+	XASSERT(cond != NULL, -1);
+	XASSERT(mutex != NULL, -1);
+
+	if (rn_sync_waiter(&waiter) != 0) {
+		return -1;
+	}
+	deadline = 0;
+	if (ms > 0) {
+		deadline = waiter.task->sched->clock + RN_MS_TO_NS(ms);
+	}
+	pthread_mutex_lock(&cond->lock);
+	rn_list_append(&cond->waiters, &waiter.node);
+	pthread_mutex_unlock(&cond->lock);
+	rn_mutex_unlock(mutex);
+	ret = rn_sync_park(&cond->waiters, &cond->lock, &waiter, deadline);
+	if (rn_mutex_lock(mutex) != 0) {
+		return -1;
+	}
+	return ret;
+}
+
+/**
+ * Waits on a task condition.
+ * The mutex gets unlocked while waiting, and locked again before returning.
+ *
+ * @param cond Pointer to the condition to wait on
+ * @param mutex Pointer to the locked mutex protecting the condition
+ *
+ * @return 0 if the condition has been signaled, otherwise -1
+ */
+int rn_cond_wait(rn_cond_t *cond, rn_mutex_t *mutex)
+{
+	return rn_cond_timedwait(cond, mutex, 0);
+}
+
+/**
+ * Wakes up the first task waiting on a condition, if any.
+ *
+ * @param cond Pointer to the condition to signal
+ */
+void rn_cond_signal(rn_cond_t *cond)
+{
+	rn_sync_waiter_t *waiter;
+
+	XASSERTN(cond != NULL);
+
+	pthread_mutex_lock(&cond->lock);
+	waiter = rn_sync_pop(&cond->waiters);
+	pthread_mutex_unlock(&cond->lock);
+	if (waiter != NULL) {
+		rn_sync_notify(waiter);
+	}
+}
+
+/**
+ * Wakes up all tasks waiting on a condition.
+ *
+ * @param cond Pointer to the condition to signal
+ */
+void rn_cond_broadcast(rn_cond_t *cond)
+{
+	XASSERTN(cond != NULL);
+
+	pthread_mutex_lock(&cond->lock);
+	rn_sync_wake_all(&cond->waiters, &cond->lock);
+}
+
+/**
+ * Initializes a wait group.
+ *
+ * @param wg Pointer to the wait group to initialize
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_waitgroup(rn_waitgroup_t *wg)
+{
+	XASSERT(wg != NULL, -1);
+
+	wg->count = 0;
+	rn_list(&wg->waiters, NULL);
+	return (pthread_mutex_init(&wg->lock, NULL) == 0 ? 0 : -1);
+}
+
+/**
+ * Destroys a wait group. No task must be waiting on it.
+ *
+ * @param wg Pointer to the wait group to destroy
+ */
+void rn_waitgroup_destroy(rn_waitgroup_t *wg)
+{
+	XASSERTN(wg != NULL);
+
+	pthread_mutex_destroy(&wg->lock);
+}
+
+/**
+ * Adds to the wait group counter. Waiting tasks are woken up
+ * when the counter drops to 0.
+ *
+ * @param wg Pointer to the wait group to use
+ * @param count Value to add, can be negative
+ */
+void rn_waitgroup_add(rn_waitgroup_t *wg, int count)
+{
+	XASSERTN(wg != NULL);
+
+	pthread_mutex_lock(&wg->lock);
+	wg->count += count;
+	if (wg->count <= 0) {
+		rn_sync_wake_all(&wg->waiters, &wg->lock);
+		return;
+	}
+	pthread_mutex_unlock(&wg->lock);
+}
+
+/**
+ * Decrements the wait group counter.
+ *
+ * @param wg Pointer to the wait group to use
+ */
+void rn_waitgroup_done(rn_waitgroup_t *wg)
+{
+	rn_waitgroup_add(wg, -1);
+}
+
+/**
+ * Waits for the wait group counter to drop to 0.
+ *
+ * @param wg Pointer to the wait group to wait on
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_waitgroup_wait(rn_waitgroup_t *wg)
+{
+	rn_sync_waiter_t waiter;
+
+	XASSERT(wg != NULL, -1);
+
+	pthread_mutex_lock(&wg->lock);
+	if (wg->count <= 0) {
+		pthread_mutex_unlock(&wg->lock);
+		return 0;
+	}
+	if (rn_sync_waiter(&waiter) != 0) {
+		pthread_mutex_unlock(&wg->lock);
+		return -1;
+	}
+	rn_list_append(&wg->waiters, &waiter.node);
+	pthread_mutex_unlock(&wg->lock);
+	return rn_sync_park(&wg->waiters, &wg->lock, &waiter, 0);
+}
@@ -16,18 +16,258 @@
 
 static __thread rn_task_t *current_task = NULL;
 
-static int rn_task_cmp(rn_rbtree_node_t *node1, rn_rbtree_node_t *node2)
+typedef struct rn_task_remote_s {
+	rn_remote_msg_t msg;
+	void (*function)(void *arg);
+	void *arg;
+} rn_task_remote_t;
+
+/**
+ * Converts a deadline to timing wheel ticks, rounding up.
+ *
+ * @param deadline Deadline in ns
+ *
+ * @return Number of ticks
+ */
+static inline uint64_t rn_task_tick(uint64_t deadline)
 {
-	rn_task_t *task1 = container_of(node1, rn_task_t, proc_node);
-	rn_task_t *task2 = container_of(node2, rn_task_t, proc_node);
+	return (deadline + RN_TASK_TICK - 1) / RN_TASK_TICK;
+}
 
-	if (task1 == task2) {
-		return 0;
+/**
+ * Reads the monotonic clock, used to measure task run time.
+ * The scheduler clock can't be used as it is only updated once per poll.
+ *
+ * @return Current time in ns
+ */
+static inline uint64_t rn_task_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Rounds a stack size up to a multiple of the page size.
+ * A size of 0 selects the scheduler default stack size.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param size Requested stack size
+ *
+ * @return Stack size to be used
+ */
+static size_t rn_task_stack_size(rn_sched_t *sched, size_t size)
+{
+	size_t pagesize;
+
+	if (size == 0) {
+		return sched->driver.pool.stack_size;
 	}
-	if (timercmp(&task1->tv, &task2->tv, <)) {
-		return -1;
+	pagesize = getpagesize();
+	return (size + pagesize - 1) & ~(pagesize - 1);
+}
+
+/**
+ * Allocates a new task along with its stack.
+ * The stack is mapped with a PROT_NONE guard page below it, so that
+ * a stack overflow faults instead of corrupting memory. Stack pages
+ * are only committed once touched.
+ *
+ * @param stack_size Stack size, must be a multiple of the page size
+ *
+ * @return Pointer to the new task, or NULL if an error occurs
+ */
+static rn_task_t *rn_task_alloc(size_t stack_size)
+{
+	char *stack;
+	size_t pagesize;
+	rn_task_t *task;
+
+	task = malloc(sizeof(*task));
+	if (task == NULL) {
+		return NULL;
+	}
+	pagesize = getpagesize();
+	stack = mmap(NULL, stack_size + pagesize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+	if (stack == MAP_FAILED) {
+		free(task);
+		return NULL;
+	}
+	if (mprotect(stack, pagesize, PROT_NONE) != 0) {
+		munmap(stack, stack_size + pagesize);
+		free(task);
+		return NULL;
+	}
+	task->context.stack.sp = stack + pagesize;
+	task->context.stack.size = stack_size;
+
+#ifdef RINOO_DEBUG
+	/* This code avoids valgrind to mix stack switches */
+	task->valgrind_stackid = VALGRIND_STACK_REGISTER(task->context.stack.sp, task->context.stack.sp + stack_size);
+#endif /* !RINOO_DEBUG */
+
+	return task;
+}
+
+/**
+ * Gives task memory back to the system.
+ *
+ * @param task Pointer to the task to free
+ */
+static void rn_task_free(rn_task_t *task)
+{
+	size_t pagesize;
+
+	if (task->stackless) {
+		free(task);
+		return;
+	}
+
+#ifdef RINOO_DEBUG
+	VALGRIND_STACK_DEREGISTER(task->valgrind_stackid);
+#endif /* !RINOO_DEBUG */
+
+	pagesize = getpagesize();
+	munmap(task->context.stack.sp - pagesize, task->context.stack.size + pagesize);
+	free(task);
+}
+
+/**
+ * Gets a task from the scheduler task pool.
+ * A new task is allocated if the pool is empty or if the requested
+ * stack size is not the scheduler default one.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param stack_size Stack size of the task
+ *
+ * @return Pointer to a task, or NULL if an error occurs
+ */
+static rn_task_t *rn_task_pool_get(rn_sched_t *sched, size_t stack_size)
+{
+	rn_list_node_t *node;
+	rn_task_pool_t *pool = &sched->driver.pool;
+
+	if (stack_size != pool->stack_size) {
+		return rn_task_alloc(stack_size);
+	}
+	node = rn_list_pop(&pool->tasks);
+	if (node != NULL) {
+		pool->stats.hits++;
+		return container_of(node, rn_task_t, pool_node);
+	}
+	pool->stats.misses++;
+	return rn_task_alloc(stack_size);
+}
+
+/**
+ * Puts a task back to the scheduler task pool.
+ * The task is freed if the pool has reached its high watermark.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param task Pointer to the task to recycle
+ */
+static void rn_task_pool_put(rn_sched_t *sched, rn_task_t *task)
+{
+	rn_task_pool_t *pool = &sched->driver.pool;
+
+	if (task->context.stack.size != pool->stack_size) {
+		rn_task_free(task);
+		return;
+	}
+	if (rn_list_size(&pool->tasks) >= pool->high) {
+		pool->stats.released++;
+		rn_task_free(task);
+		return;
+	}
+	pool->stats.recycled++;
+	rn_list_put(&pool->tasks, &task->pool_node);
+}
+
+/**
+ * Releases all tasks kept in the scheduler task pool.
+ *
+ * @param sched Pointer to the scheduler to use
+ */
+static void rn_task_pool_flush(rn_sched_t *sched)
+{
+	rn_list_node_t *node;
+
+	while ((node = rn_list_pop(&sched->driver.pool.tasks)) != NULL) {
+		rn_task_free(container_of(node, rn_task_t, pool_node));
+	}
+}
+
+/**
+ * Sets task pool watermarks.
+ * The pool is filled up to `low` tasks and never keeps more than `high` tasks.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param low Number of tasks to preallocate
+ * @param high Maximum number of tasks to keep for reuse
+ *
+ * @return 0 on success, or -1 if an error occurs
+ */
+int rn_task_pool_set(rn_sched_t *sched, uint32_t low, uint32_t high)
+{
+	rn_task_t *task;
+	rn_list_node_t *node;
+	rn_task_pool_t *pool;
+
+	XASSERT(sched != NULL, -1);
+	XASSERT(low <= high, -1);
+
+	pool = &sched->driver.pool;
+	pool->low = low;
+	pool->high = high;
+	while (rn_list_size(&pool->tasks) > pool->high) {
+		node = rn_list_pop(&pool->tasks);
+		pool->stats.released++;
+		rn_task_free(container_of(node, rn_task_t, pool_node));
 	}
-	return 1;
+	while (rn_list_size(&pool->tasks) < pool->low) {
+		task = rn_task_alloc(pool->stack_size);
+		if (task == NULL) {
+			return -1;
+		}
+		rn_list_put(&pool->tasks, &task->pool_node);
+	}
+	return 0;
+}
+
+/**
+ * Gets task pool statistics.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param stats Pointer to the statistics structure to fill
+ */
+void rn_task_pool_stats(rn_sched_t *sched, rn_task_pool_stats_t *stats)
+{
+	XASSERTN(sched != NULL);
+	XASSERTN(stats != NULL);
+
+	*stats = sched->driver.pool.stats;
+	stats->size = rn_list_size(&sched->driver.pool.tasks);
+}
+
+/**
+ * Sets the default stack size of tasks created on a scheduler.
+ * Tasks kept in the task pool are released and the pool is refilled
+ * up to its low watermark with the new stack size.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param size Default stack size
+ *
+ * @return 0 on success, or -1 if an error occurs
+ */
+int rn_task_stack_set(rn_sched_t *sched, size_t size)
+{
+	XASSERT(sched != NULL, -1);
+	XASSERT(size > 0, -1);
+
+	rn_task_pool_flush(sched);
+	sched->driver.pool.stack_size = rn_task_stack_size(sched, size);
+	return rn_task_pool_set(sched, sched->driver.pool.low, sched->driver.pool.high);
 }
 
 /**
@@ -42,7 +282,18 @@ int rn_task_driver_init(rn_sched_t *sched)
 {
 	XASSERT(sched != NULL, -1);
 
-	if (rn_rbtree(&sched->driver.proc_tree, rn_task_cmp, NULL) != 0) {
+	if (rn_wheel(&sched->driver.timers, sched->clock / RN_TASK_TICK) != 0) {
+		return -1;
+	}
+	if (rn_list(&sched->driver.runq, NULL) != 0) {
+		return -1;
+	}
+	if (rn_list(&sched->driver.pool.tasks, NULL) != 0) {
+		return -1;
+	}
+	sched->driver.pool.stack_size = rn_task_stack_size(sched, RN_TASK_STACK_SIZE);
+	if (rn_task_pool_set(sched, RN_TASK_POOL_LOW, RN_TASK_POOL_HIGH) != 0) {
+		rn_task_pool_flush(sched);
 		return -1;
 	}
 	sched->driver.main.sched = sched;
@@ -60,11 +311,16 @@ void rn_task_driver_destroy(rn_sched_t *sched)
 {
 	XASSERTN(sched != NULL);
 
-	rn_rbtree_flush(&sched->driver.proc_tree);
+	rn_list_flush(&sched->driver.runq, NULL);
+	rn_wheel_flush(&sched->driver.timers);
+	rn_task_pool_flush(sched);
 }
 
 /**
  * Runs pending tasks and returns time before next task (in ms).
+ * Tasks in the run queue are run first, in order. Tasks queued while
+ * draining the run queue are left for the next call, so that a yielding
+ * task cannot starve I/O. Expired timers are run afterwards.
  * If no task is queued, -1 is returned.
  *
  * @param sched Pointer to the scheduler to use
@@ -73,23 +329,55 @@ void rn_task_driver_destroy(rn_sched_t *sched)
  */
 int rn_task_driver_run(rn_sched_t *sched)
 {
+	size_t nbready;
+	uint64_t now;
+	uint64_t next;
 	rn_task_t *task;
-	struct timeval tv;
-	rn_rbtree_node_t *head;
+	rn_timer_t *timer;
+	rn_list_node_t *lnode;
+	rn_wheel_node_t *node;
 
 	XASSERT(sched != NULL, -1);
 
-	while ((head = rn_rbtree_head(&sched->driver.proc_tree)) != NULL) {
-		task = container_of(head, rn_task_t, proc_node);
-		if (timercmp(&task->tv, &sched->clock, <=)) {
-			rn_task_unschedule(task);
-			rn_task_resume(task);
-		} else {
-			timersub(&task->tv, &sched->clock, &tv);
-			return (tv.tv_sec * 1000) + (tv.tv_usec / 1000);
+	nbready = rn_list_size(&sched->driver.runq);
+	while (nbready-- > 0 && (lnode = rn_list_pop(&sched->driver.runq)) != NULL) {
+		task = container_of(lnode, rn_task_t, run_node);
+		task->scheduled = false;
+		rn_task_resume(task);
+	}
+	now = sched->clock / RN_TASK_TICK;
+	while ((node = rn_wheel_pop(&sched->driver.timers, now)) != NULL) {
+		rn_stats_inc(sched, timers);
+		timer = container_of(node, rn_timer_t, node);
+		if (timer->function != NULL) {
+			sched->driver.nbtimers--;
+			rn_timer_run(sched, timer);
+			continue;
+		}
+		task = container_of(timer, rn_task_t, timer);
+		if (sched->hist != NULL) {
+			rn_stats_lag(sched, (sched->clock > task->deadline ? sched->clock - task->deadline : 0));
 		}
+		task->scheduled = false;
+		task->deadline = 0;
+		rn_task_resume(task);
+	}
+	if (rn_list_size(&sched->driver.runq) > 0) {
+		return 0;
+	}
+	next = rn_wheel_next(&sched->driver.timers);
+	if (next == UINT64_MAX) {
+		return -1;
+	}
+	if (next <= now) {
+		return 0;
+	}
+	/* Ticks to ms, rounding up not to wake up early */
+	next = ((next - now) * RN_TASK_TICK + RN_NS_PER_MS - 1) / RN_NS_PER_MS;
+	if (next > INT_MAX) {
+		return INT_MAX;
 	}
-	return -1;
+	return next;
 }
 
 /**
@@ -102,21 +390,44 @@ int rn_task_driver_run(rn_sched_t *sched)
 int rn_task_driver_stop(rn_sched_t *sched)
 {
 	rn_task_t *task;
-	rn_rbtree_node_t *head;
+	rn_timer_t *timer;
+	rn_wheel_t *timers;
+	rn_list_node_t *lnode;
+	rn_wheel_node_t *node;
 
 	XASSERT(sched != NULL, -1);
 	XASSERT(sched->stop == true, -1);
 
-	while ((head = rn_rbtree_head(&sched->driver.proc_tree)) != NULL) {
-		task = container_of(head, rn_task_t, proc_node);
-		rn_task_unschedule(task);
-		rn_task_resume(task);
+	timers = &sched->driver.timers;
+	while (rn_list_size(&sched->driver.runq) > 0 || timers->size > 0) {
+		lnode = rn_list_pop(&sched->driver.runq);
+		if (lnode != NULL) {
+			task = container_of(lnode, rn_task_t, run_node);
+			task->scheduled = false;
+			rn_task_resume(task);
+			continue;
+		}
+		node = rn_wheel_pop(timers, rn_wheel_next(timers));
+		if (node != NULL) {
+			timer = container_of(node, rn_timer_t, node);
+			if (timer->function != NULL) {
+				/* Callback timers are not run on stop */
+				sched->driver.nbtimers--;
+				rn_timer_stop(sched, timer);
+				continue;
+			}
+			task = container_of(timer, rn_task_t, timer);
+			task->scheduled = false;
+			task->deadline = 0;
+			rn_task_resume(task);
+		}
 	}
 	return 0;
 }
 
 /**
  * Returns number of pending tasks.
+ * Callback timers are not counted, they don't keep a scheduler running.
  *
  * @param sched Pointer to the schedulter to use
  *
@@ -124,7 +435,7 @@ int rn_task_driver_stop(rn_sched_t *sched)
  */
 uint32_t rn_task_driver_nbpending(rn_sched_t *sched)
 {
-	return sched->driver.proc_tree.size;
+	return rn_list_size(&sched->driver.runq) + sched->driver.timers.size - sched->driver.nbtimers;
 }
 
 /**
@@ -140,15 +451,17 @@ rn_task_t *rn_task_driver_getcurrent(rn_sched_t *sched)
 }
 
 /**
- * Create a new task.
+ * Create a new task with a given stack size.
  *
  * @param sched sched Pointer to a scheduler to use
+ * @param parent Task to switch to once the routine returns
  * @param function Routine to call for that task
  * @param arg Routine argument to be passed
+ * @param stack_size Task stack size, 0 for the scheduler default
  *
  * @return Pointer to the created task, or NULL if an error occurs
  */
-rn_task_t *rn_task(rn_sched_t *sched, rn_task_t *parent, void (*function)(void *arg), void *arg)
+static rn_task_t *rn_task_create(rn_sched_t *sched, rn_task_t *parent, void (*function)(void *arg), void *arg, size_t stack_size)
 {
 	rn_task_t *task;
 
@@ -156,29 +469,73 @@ rn_task_t *rn_task(rn_sched_t *sched, rn_task_t *parent, void (*function)(void *
 	XASSERT(parent != NULL, NULL);
 	XASSERT(function != NULL, NULL);
 
-	task = malloc(sizeof(*task));
+	task = rn_task_pool_get(sched, rn_task_stack_size(sched, stack_size));
 	if (task == NULL) {
 		return NULL;
 	}
 	task->sched = sched;
 	task->scheduled = false;
-	task->context.stack.sp = task->stack;
-	task->context.stack.size = sizeof(task->stack);
+	task->stackless = false;
+	task->function = function;
+	task->arg = arg;
 	task->context.link = &parent->context;
-	memset(&task->tv, 0, sizeof(task->tv));
-	memset(&task->proc_node, 0, sizeof(task->proc_node));
+	task->deadline = 0;
+	task->cputime = 0;
+	memset(&task->timer, 0, sizeof(task->timer));
+	memset(&task->run_node, 0, sizeof(task->run_node));
 	fcontext(&task->context, function, arg);
+	rn_stats_inc(sched, created);
+	__atomic_add_fetch(&sched->stats.live, 1, __ATOMIC_RELAXED);
+	return task;
+}
 
-#ifdef RINOO_DEBUG
-	/* This code avoids valgrind to mix stack switches */
-	task->valgrind_stackid = VALGRIND_STACK_REGISTER(task->stack, task->stack + sizeof(task->stack));
-#endif /* !RINOO_DEBUG */
+/**
+ * Create a new task.
+ *
+ * @param sched sched Pointer to a scheduler to use
+ * @param parent Task to switch to once the routine returns
+ * @param function Routine to call for that task
+ * @param arg Routine argument to be passed
+ *
+ * @return Pointer to the created task, or NULL if an error occurs
+ */
+rn_task_t *rn_task(rn_sched_t *sched, rn_task_t *parent, void (*function)(void *arg), void *arg)
+{
+	return rn_task_create(sched, parent, function, arg, 0);
+}
+
+/**
+ * Create a new stackless task.
+ *
+ * @param sched Pointer to a scheduler to use
+ * @param function Pointer to the task function
+ * @param arg Argument to be passed to the task function
+ *
+ * @return Pointer to the created task, or NULL if an error occurs
+ */
+rn_task_t *rn_task_stackless(rn_sched_t *sched, void (*function)(void *arg), void *arg)
+{
+	rn_task_t *task;
+
+	XASSERT(sched != NULL, NULL);
+	XASSERT(function != NULL, NULL);
 
+	task = calloc(1, sizeof(*task));
+	if (task == NULL) {
+		return NULL;
+	}
+	task->sched = sched;
+	task->stackless = true;
+	task->function = function;
+	task->arg = arg;
+	rn_stats_inc(sched, created);
+	__atomic_add_fetch(&sched->stats.live, 1, __ATOMIC_RELAXED);
 	return task;
 }
 
 /**
  * Destroy a task.
+ * The task and its stack are recycled through the scheduler task pool.
  *
  * @param task Pointer to the task to destroy
  */
@@ -186,11 +543,10 @@ void rn_task_destroy(rn_task_t *task)
 {
 	XASSERTN(task != NULL);
 
-#ifdef RINOO_DEBUG
-	VALGRIND_STACK_DEREGISTER(task->valgrind_stackid);
-#endif /* !RINOO_DEBUG */
 	rn_task_unschedule(task);
-	free(task);
+	rn_stats_inc(task->sched, destroyed);
+	__atomic_sub_fetch(&task->sched->stats.live, 1, __ATOMIC_RELAXED);
+	rn_task_pool_put(task->sched, task);
 }
 
 /**
@@ -203,17 +559,129 @@ void rn_task_destroy(rn_task_t *task)
  * @return 0 on success, otherwise -1
  */
 int rn_task_start(rn_sched_t *sched, void (*function)(void *arg), void *arg)
+{
+	return rn_task_start_stack(sched, function, arg, 0);
+}
+
+/**
+ * Queue a task with a specific stack size to be launch asynchronously.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param function Pointer to the routine function
+ * @param arg Argument to be passed to the routine function
+ * @param stack_size Task stack size, 0 for the scheduler default
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_task_start_stack(rn_sched_t *sched, void (*function)(void *arg), void *arg, size_t stack_size)
 {
 	rn_task_t *task;
 
-	task = rn_task(sched, &sched->driver.main, function, arg);
+	task = rn_task_create(sched, &sched->driver.main, function, arg, stack_size);
 	if (task == NULL) {
 		return -1;
 	}
-	rn_task_schedule(task, NULL);
+	rn_task_schedule(task, 0);
 	return 0;
 }
 
+/**
+ * Queue a task which can be run by any scheduler of the family.
+ * If work stealing is enabled, the task can be stolen by an idle
+ * spawn until it gets started. Otherwise this is the same as rn_task_start.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param function Pointer to the routine function
+ * @param arg Argument to be passed to the routine function
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_task_start_stealable(rn_sched_t *sched, void (*function)(void *arg), void *arg)
+{
+	rn_task_t *task;
+
+	task = rn_task_create(sched, &sched->driver.main, function, arg, 0);
+	if (task == NULL) {
+		return -1;
+	}
+	if (sched->steal.enabled == false) {
+		rn_task_schedule(task, 0);
+		return 0;
+	}
+	rn_steal_push(sched, task);
+	return 0;
+}
+
+/**
+ * Queue a stackless task to be launch asynchronously.
+ * Its function is run on the scheduler main context.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param function Pointer to the task function
+ * @param arg Argument to be passed to the task function
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_task_start_stackless(rn_sched_t *sched, void (*function)(void *arg), void *arg)
+{
+	rn_task_t *task;
+
+	task = rn_task_stackless(sched, function, arg);
+	if (task == NULL) {
+		return -1;
+	}
+	rn_task_schedule(task, 0);
+	return 0;
+}
+
+/**
+ * Remote message handler starting a task on the receiving scheduler.
+ *
+ * @param sched Pointer to the scheduler processing the message
+ * @param msg Pointer to the message
+ */
+static void rn_task_remote_handler(rn_sched_t *sched, rn_remote_msg_t *msg)
+{
+	rn_task_remote_t *remote;
+
+	if (sched->draining && sched->parent != NULL && !__atomic_load_n(&sched->parent->draining, __ATOMIC_RELAXED)) {
+		/* A retired spawn hands new work over to its parent */
+		rn_remote_push(sched->parent, msg);
+		return;
+	}
+	remote = container_of(msg, rn_task_remote_t, msg);
+	rn_task_start(sched, remote->function, remote->arg);
+	free(remote);
+}
+
+/**
+ * Queue a task to be launch asynchronously on another scheduler.
+ * Unlike rn_task_start, this function can be called from any thread,
+ * even while the target scheduler is running.
+ *
+ * @param sched Pointer to the target scheduler
+ * @param function Pointer to the routine function
+ * @param arg Argument to be passed to the routine function
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_task_start_remote(rn_sched_t *sched, void (*function)(void *arg), void *arg)
+{
+	rn_task_remote_t *remote;
+
+	XASSERT(sched != NULL, -1);
+	XASSERT(function != NULL, -1);
+
+	remote = malloc(sizeof(*remote));
+	if (remote == NULL) {
+		return -1;
+	}
+	remote->msg.handler = rn_task_remote_handler;
+	remote->function = function;
+	remote->arg = arg;
+	return rn_remote_push(sched, &remote->msg);
+}
+
 /**
  * Run a task within the current task.
  * This function will return once the routine returned.
@@ -225,10 +693,26 @@ int rn_task_start(rn_sched_t *sched, void (*function)(void *arg), void *arg)
  * @return 0 on success, otherwise -1
  */
 int rn_task_run(rn_sched_t *sched, void (*function)(void *arg), void *arg)
+{
+	return rn_task_run_stack(sched, function, arg, 0);
+}
+
+/**
+ * Run a task with a specific stack size within the current task.
+ * This function will return once the routine returned.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param function Pointer to the routine function
+ * @param arg Argument to be passed to the routine function
+ * @param stack_size Task stack size, 0 for the scheduler default
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_task_run_stack(rn_sched_t *sched, void (*function)(void *arg), void *arg, size_t stack_size)
 {
 	rn_task_t *task;
 
-	task = rn_task(sched, sched->driver.current, function, arg);
+	task = rn_task_create(sched, sched->driver.current, function, arg, stack_size);
 	if (task == NULL) {
 		return -1;
 	}
@@ -238,6 +722,7 @@ int rn_task_run(rn_sched_t *sched, void (*function)(void *arg), void *arg)
 /**
  * Resume a task.
  * This function switches to the task stack by calling fcontext_swap.
+ * The function of a stackless task is called directly instead.
  *
  * @param task Pointer to the task to run or resume
  *
@@ -246,18 +731,33 @@ int rn_task_run(rn_sched_t *sched, void (*function)(void *arg), void *arg)
 int rn_task_resume(rn_task_t *task)
 {
 	int ret;
+	uint64_t start;
 	rn_task_t *old;
 	rn_task_driver_t *driver;
 
 	XASSERT(task != NULL, -1);
 
+	start = 0;
+	if (unlikely(task->sched->hist != NULL || task->sched->slow_callback != NULL || task->sched->cputime)) {
+		start = rn_task_now();
+	}
 	driver = &task->sched->driver;
 	old = driver->current;
-	driver->current = task;
+	/* The watchdog reads the current task from another thread */
+	__atomic_store_n(&driver->current, task, __ATOMIC_RELAXED);
 	current_task = task;
-	ret = fcontext_swap(&old->context, &task->context);
-	driver->current = old;
+	rn_stats_inc(task->sched, switches);
+	if (task->stackless) {
+		task->function(task->arg);
+		ret = (task->scheduled ? 1 : 0);
+	} else {
+		ret = fcontext_swap(&old->context, &task->context);
+	}
+	__atomic_store_n(&driver->current, old, __ATOMIC_RELAXED);
 	current_task = old;
+	if (unlikely(start != 0)) {
+		rn_stats_runtime(task, rn_task_now() - start);
+	}
 	if (ret == 0) {
 		/* This task is finished */
 		rn_task_destroy(task);
@@ -275,7 +775,9 @@ int rn_task_resume(rn_task_t *task)
 int rn_task_release(rn_sched_t *sched)
 {
 	XASSERT(sched != NULL, -1);
+	XASSERT(sched->driver.current->stackless == false, -1);
 
+	rn_stats_inc(sched, switches);
 	fcontext_swap(&sched->driver.current->context, &sched->driver.main.context);
 	if (sched->stop == true) {
 		rn_error_set(ECANCELED);
@@ -286,28 +788,25 @@ int rn_task_release(rn_sched_t *sched)
 
 /**
  * Schedule a task to be executed at specific time.
+ * A task with a zero deadline is put in the run queue and
+ * is run on the next scheduler iteration.
  *
  * @param task Pointer to the task to schedule
- * @param tv Pointer to a timeval representing the expected execution time
+ * @param deadline Expected execution time, in ns on the scheduler clock, or 0 for as soon as possible
  *
  * @return 0 on success or -1 if an error occurs
  */
-int rn_task_schedule(rn_task_t *task, struct timeval *tv)
+int rn_task_schedule(rn_task_t *task, uint64_t deadline)
 {
 	XASSERT(task != NULL, -1);
 	XASSERT(task->sched != NULL, -1);
 
-	if (task->scheduled == true) {
-		rn_rbtree_remove(&task->sched->driver.proc_tree, &task->proc_node);
-		task->scheduled = false;
-	}
-	if (tv != NULL) {
-		task->tv = *tv;
+	rn_task_unschedule(task);
+	if (deadline == 0) {
+		rn_list_append(&task->sched->driver.runq, &task->run_node);
 	} else {
-		memset(&task->tv, 0, sizeof(task->tv));
-	}
-	if (rn_rbtree_put(&task->sched->driver.proc_tree, &task->proc_node) != 0) {
-		return -1;
+		task->deadline = deadline;
+		rn_wheel_put(&task->sched->driver.timers, &task->timer.node, rn_task_tick(deadline));
 	}
 	task->scheduled = true;
 	return 0;
@@ -326,8 +825,12 @@ int rn_task_unschedule(rn_task_t *task)
 	XASSERT(task->sched != NULL, -1);
 
 	if (task->scheduled == true) {
-		rn_rbtree_remove(&task->sched->driver.proc_tree, &task->proc_node);
-		memset(&task->tv, 0, sizeof(task->tv));
+		if (task->timer.node.slot != NULL) {
+			rn_wheel_remove(&task->sched->driver.timers, &task->timer.node);
+		} else {
+			rn_list_remove(&task->sched->driver.runq, &task->run_node);
+		}
+		task->deadline = 0;
 		task->scheduled = false;
 	}
 	return 0;
@@ -343,20 +846,14 @@ int rn_task_unschedule(rn_task_t *task)
  */
 int rn_task_wait(rn_sched_t *sched, uint32_t ms)
 {
-	struct timeval res;
-	struct timeval toadd;
+	uint64_t deadline;
 
-	if (ms == 0) {
-		if (rn_task_schedule(rn_task_driver_getcurrent(sched), NULL) != 0) {
-			return -1;
-		}
-	} else {
-		toadd.tv_sec = ms / 1000;
-		toadd.tv_usec = (ms % 1000) * 1000;
-		timeradd(&sched->clock, &toadd, &res);
-		if (rn_task_schedule(rn_task_driver_getcurrent(sched), &res) != 0) {
-			return -1;
-		}
+	deadline = 0;
+	if (ms > 0) {
+		deadline = sched->clock + RN_MS_TO_NS(ms);
+	}
+	if (rn_task_schedule(rn_task_driver_getcurrent(sched), deadline) != 0) {
+		return -1;
 	}
 	return rn_task_release(sched);
 }
@@ -372,25 +869,25 @@ int rn_task_wait(rn_sched_t *sched, uint32_t ms)
 int rn_task_pause(rn_sched_t *sched)
 {
 	rn_task_t *task;
-	struct timeval tv;
+	uint64_t deadline;
 
 	task = rn_task_driver_getcurrent(sched);
 	if (task == &sched->driver.main) {
 		return 0;
 	}
 	if (task->scheduled == true) {
-		tv = task->tv;
-		if (rn_task_schedule(task, NULL) != 0) {
+		deadline = task->deadline;
+		if (rn_task_schedule(task, 0) != 0) {
 			return -1;
 		}
 		if (rn_task_release(sched) != 0) {
 			return -1;
 		}
-		if (rn_task_schedule(task, &tv) != 0) {
+		if (rn_task_schedule(task, deadline) != 0) {
 			return -1;
 		}
 	} else {
-		if (rn_task_schedule(task, NULL) != 0) {
+		if (rn_task_schedule(task, 0) != 0) {
 			return -1;
 		}
 		if (rn_task_release(sched) != 0) {
@@ -0,0 +1,72 @@
+/**
+ * @file   rn_bchannel.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Buffered channel unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define NBMSGS		100
+#define NBREADERS	3
+
+int nbread = 0;
+int nbdone = 0;
+
+void writer(void *channel)
+{
+	intptr_t i;
+
+	for (i = 1; i <= NBMSGS; i++) {
+		XTEST(rn_bchannel_put(channel, (void *) i) == 0);
+		XTEST(rn_bchannel_size(channel) <= 4);
+	}
+	rn_bchannel_close(channel);
+	XTEST(rn_bchannel_put(channel, (void *) 1) == -1);
+}
+
+void reader(void *channel)
+{
+	intptr_t prev;
+	intptr_t value;
+
+	prev = 0;
+	while ((value = (intptr_t) rn_bchannel_get(channel)) != 0) {
+		/* Messages are read in order */
+		XTEST(value > prev);
+		prev = value;
+		nbread++;
+	}
+	nbdone++;
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	int i;
+	rn_sched_t *sched;
+	rn_bchannel_t *channel;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	channel = rn_bchannel(sched, 4);
+	XTEST(channel != NULL);
+	for (i = 0; i < NBREADERS; i++) {
+		XTEST(rn_task_start(sched, reader, channel) == 0);
+	}
+	XTEST(rn_task_start(sched, writer, channel) == 0);
+	rn_scheduler_loop(sched);
+	XTEST(nbread == NBMSGS);
+	XTEST(nbdone == NBREADERS);
+	rn_bchannel_destroy(channel);
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
@@ -0,0 +1,76 @@
+/**
+ * @file   rn_mchannel.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Cross-scheduler channel unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define NBSPAWNS	2
+#define NBMSGS		10000
+
+rn_mchannel_t *channel;
+rn_mchannel_t *done;
+
+void producer(void *unused(arg))
+{
+	intptr_t i;
+
+	for (i = 1; i <= NBMSGS; i++) {
+		XTEST(rn_mchannel_put(channel, (void *) i) == 0);
+	}
+	XTEST(rn_mchannel_put(done, (void *) 1) == 0);
+}
+
+void consumer(void *unused(arg))
+{
+	int i;
+	intptr_t sum;
+
+	sum = 0;
+	for (i = 0; i < NBSPAWNS * NBMSGS; i++) {
+		sum += (intptr_t) rn_mchannel_get(channel);
+	}
+	XTEST(sum == (intptr_t) NBSPAWNS * NBMSGS * (NBMSGS + 1) / 2);
+	for (i = 0; i < NBSPAWNS; i++) {
+		XTEST(rn_mchannel_get(done) != NULL);
+	}
+	rn_mchannel_close(channel);
+	XTEST(rn_mchannel_put(channel, (void *) 1) == -1);
+	XTEST(rn_mchannel_get(channel) == NULL);
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	int i;
+	rn_sched_t *sched;
+
+	/* Small ring so that producers get blocked */
+	channel = rn_mchannel(3);
+	XTEST(channel != NULL);
+	XTEST(channel->mask == 3);
+	done = rn_mchannel(NBSPAWNS);
+	XTEST(done != NULL);
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(rn_spawn(sched, NBSPAWNS) == 0);
+	for (i = 1; i <= NBSPAWNS; i++) {
+		XTEST(rn_task_start(rn_spawn_get(sched, i), producer, NULL) == 0);
+	}
+	XTEST(rn_task_start(sched, consumer, NULL) == 0);
+	rn_scheduler_loop(sched);
+	rn_scheduler_destroy(sched);
+	rn_mchannel_destroy(channel);
+	rn_mchannel_destroy(done);
+	XPASS();
+}
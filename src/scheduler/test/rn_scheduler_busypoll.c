@@ -0,0 +1,48 @@
+/**
+ * @file   rn_scheduler_busypoll.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  rn_scheduler_busypoll unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+void task_func(void *arg)
+{
+	uint64_t start;
+	rn_sched_t *sched = arg;
+
+	start = sched->clock;
+	XTEST(rn_task_wait(sched, 50) == 0);
+	XTEST(sched->clock - start >= 50 * RN_TASK_TICK);
+}
+
+/**
+ * Main function for this unit test.
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	rn_sched_t *sched;
+	rn_sched_stats_t stats;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	/* Busy polling is disabled by default */
+	XTEST(rn_task_start(sched, task_func, sched) == 0);
+	rn_scheduler_loop(sched);
+	rn_stats_get(sched, &stats);
+	XTEST(stats.spins == 0);
+	XTEST(stats.waits > 0);
+	rn_scheduler_busypoll(sched, 1000);
+	XTEST(rn_task_start(sched, task_func, sched) == 0);
+	rn_scheduler_loop(sched);
+	rn_stats_get(sched, &stats);
+	XTEST(stats.spins > 1);
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
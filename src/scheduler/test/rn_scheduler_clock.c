@@ -0,0 +1,64 @@
+/**
+ * @file   rn_scheduler_clock.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Scheduler clock unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+int checker = 0;
+
+void task_func(void *sched)
+{
+	uint64_t prev;
+	rn_sched_t *cur = sched;
+
+	printf("%s start\n", __FUNCTION__);
+	prev = cur->clock;
+	rn_task_wait(sched, 100);
+	XTEST(cur->clock >= prev + 100 * RN_TASK_TICK);
+	XTEST(cur->clock < prev + 200 * RN_TASK_TICK);
+	checker++;
+	printf("%s end\n", __FUNCTION__);
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	struct timespec ts;
+	rn_sched_t *sched;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(sched->clock_id == CLOCK_MONOTONIC);
+	XTEST(clock_gettime(CLOCK_MONOTONIC, &ts) == 0);
+	XTEST(sched->clock <= (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec);
+	XTEST(rn_scheduler_clock_set(sched, CLOCK_REALTIME) == -1);
+	XTEST(rn_task_start(sched, task_func, sched) == 0);
+	rn_scheduler_loop(sched);
+	XTEST(rn_scheduler_clock_set(sched, CLOCK_MONOTONIC_COARSE) == 0);
+	XTEST(sched->clock_id == CLOCK_MONOTONIC_COARSE);
+	XTEST(rn_task_start(sched, task_func, sched) == 0);
+	rn_scheduler_loop(sched);
+	XTEST(checker == 2);
+	/* Spawns end with the main loop, leaving empty slots */
+	XTEST(rn_spawn(sched, 2) == 0);
+	XTEST(rn_task_start(sched, task_func, sched) == 0);
+	rn_scheduler_loop(sched);
+	XTEST(checker == 3);
+	XTEST(rn_spawn_get(sched, 1) == NULL);
+	XTEST(rn_spawn_get(sched, 2) == NULL);
+	XTEST(rn_scheduler_clock_set(sched, CLOCK_MONOTONIC) == 0);
+	XTEST(sched->clock_id == CLOCK_MONOTONIC);
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
@@ -0,0 +1,88 @@
+/**
+ * @file   rn_scheduler_drain.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Scheduler drain unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define NBSPAWNS	4
+
+int nbshort = 0;
+int nblong = 0;
+int nbcancel = 0;
+
+void short_task(void *unused(arg))
+{
+	XTEST(rn_task_wait(rn_scheduler_self(), 100) == 0);
+	__atomic_add_fetch(&nbshort, 1, __ATOMIC_SEQ_CST);
+}
+
+void long_task(void *unused(arg))
+{
+	/* Cancelled when the drain deadline is over */
+	XTEST(rn_task_wait(rn_scheduler_self(), 100000) == -1);
+	__atomic_add_fetch(&nblong, 1, __ATOMIC_SEQ_CST);
+}
+
+void listen_task(void *unused(arg))
+{
+	int fds[2];
+	rn_sched_node_t node;
+
+	XTEST(pipe(fds) == 0);
+	memset(&node, 0, sizeof(node));
+	node.fd = fds[0];
+	node.sched = rn_scheduler_self();
+	node.listening = true;
+	XTEST(rn_scheduler_waitfor(&node, RN_MODE_IN) == -1);
+	XTEST(rn_error == ECANCELED);
+	__atomic_add_fetch(&nbcancel, 1, __ATOMIC_SEQ_CST);
+	close(fds[0]);
+	close(fds[1]);
+}
+
+void drainer(void *sched)
+{
+	rn_task_wait(sched, 20);
+	rn_scheduler_drain(sched, 500);
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	int i;
+	time_t start;
+	rn_sched_t *cur;
+	rn_sched_t *sched;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(rn_spawn(sched, NBSPAWNS) == 0);
+	for (i = 0; i <= NBSPAWNS; i++) {
+		cur = rn_spawn_get(sched, i);
+		XTEST(cur != NULL);
+		rn_scheduler_keepalive(cur, true);
+		XTEST(rn_task_start(cur, short_task, NULL) == 0);
+		XTEST(rn_task_start(cur, long_task, NULL) == 0);
+		XTEST(rn_task_start(cur, listen_task, NULL) == 0);
+	}
+	XTEST(rn_task_start(sched, drainer, sched) == 0);
+	start = time(NULL);
+	rn_scheduler_loop(sched);
+	rn_scheduler_destroy(sched);
+	XTEST(time(NULL) - start < 10);
+	XTEST(nbshort == NBSPAWNS + 1);
+	XTEST(nblong == NBSPAWNS + 1);
+	XTEST(nbcancel == NBSPAWNS + 1);
+	XPASS();
+}
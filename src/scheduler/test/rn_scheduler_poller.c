@@ -0,0 +1,129 @@
+/**
+ * @file   rn_scheduler_poller.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  rn_scheduler_poller_set unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#ifdef RINOO_IO_URING
+
+extern const rn_socket_class_t socket_class_tcp;
+
+#define NBSPAWNS	2
+
+rn_sched_t *sched;
+int nbremote = 0;
+
+void process_client(void *arg)
+{
+	char b;
+	rn_socket_t *socket = arg;
+
+	XTEST(rn_socket_write(socket, "abcdef", 6) == 6);
+	XTEST(rn_socket_read(socket, &b, 1) == 1);
+	XTEST(b == 'b');
+	/* Nothing gets written anymore, read times out */
+	XTEST(rn_socket_timeout(socket, 100) == 0);
+	XTEST(rn_socket_read(socket, &b, 1) == -1);
+	XTEST(rn_error == ETIMEDOUT);
+	rn_socket_destroy(socket);
+}
+
+void server_func(void *unused(arg))
+{
+	rn_addr_t addr;
+	rn_socket_t *server;
+	rn_socket_t *client;
+
+	server = rn_socket(sched, &socket_class_tcp);
+	XTEST(server != NULL);
+	rn_addr4(&addr, "127.0.0.1", 4243);
+	XTEST(rn_socket_bind(server, &addr, 42) == 0);
+	client = rn_socket_accept(server, &addr);
+	XTEST(client != NULL);
+	rn_task_start(sched, process_client, client);
+	rn_socket_destroy(server);
+}
+
+void client_func(void *unused(arg))
+{
+	char a;
+	char cur;
+	rn_addr_t addr;
+	rn_socket_t *socket;
+
+	socket = rn_socket(sched, &socket_class_tcp);
+	XTEST(socket != NULL);
+	rn_addr4(&addr, "127.0.0.1", 4243);
+	XTEST(rn_socket_connect(socket, &addr) == 0);
+	for (cur = 'a'; cur <= 'f'; cur++) {
+		XTEST(rn_socket_read(socket, &a, 1) == 1);
+		XTEST(a == cur);
+	}
+	XTEST(rn_socket_write(socket, "b", 1) == 1);
+	/* Wait for the server read to time out */
+	XTEST(rn_socket_read(socket, &a, 1) == -1);
+	rn_socket_destroy(socket);
+}
+
+void remote_task(void *unused(arg))
+{
+	XTEST(rn_scheduler_self()->poller == &rn_poller_uring);
+	if (__atomic_add_fetch(&nbremote, 1, __ATOMIC_RELAXED) == NBSPAWNS) {
+		rn_scheduler_stop(sched);
+	}
+}
+
+void remote_func(void *unused(arg))
+{
+	int i;
+
+	rn_task_wait(sched, 50);
+	for (i = 1; i <= NBSPAWNS; i++) {
+		XTEST(rn_task_start_remote(rn_spawn_get(sched, i), remote_task, NULL) == 0);
+	}
+}
+
+/**
+ * Main function for this unit test.
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	int i;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(sched->poller == &rn_poller_epoll);
+	XTEST(rn_scheduler_poller_set(sched, &rn_poller_uring) == 0);
+	XTEST(sched->poller == &rn_poller_uring);
+	XTEST(rn_task_start(sched, server_func, NULL) == 0);
+	XTEST(rn_task_start(sched, client_func, NULL) == 0);
+	rn_scheduler_loop(sched);
+	XTEST(rn_spawn(sched, NBSPAWNS) == 0);
+	for (i = 0; i <= NBSPAWNS; i++) {
+		XTEST(rn_spawn_get(sched, i)->poller == &rn_poller_uring);
+		rn_scheduler_keepalive(rn_spawn_get(sched, i), true);
+	}
+	XTEST(rn_task_start(sched, remote_func, NULL) == 0);
+	rn_scheduler_loop(sched);
+	XTEST(nbremote == NBSPAWNS);
+	XTEST(rn_scheduler_poller_set(sched, &rn_poller_epoll) == 0);
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
+
+#else
+
+int main()
+{
+	XPASS();
+}
+
+#endif /* !RINOO_IO_URING */
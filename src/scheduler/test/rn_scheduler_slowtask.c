@@ -0,0 +1,58 @@
+/**
+ * @file   rn_scheduler_slowtask.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Task run time histogram and slow task callback unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+int nbslow = 0;
+
+void slow_task(void *unused(arg))
+{
+	/* Blocks the scheduler for 20ms */
+	usleep(20000);
+}
+
+void fast_task(void *arg)
+{
+	rn_sched_t *sched = arg;
+
+	XTEST(rn_task_wait(sched, 10) == 0);
+}
+
+void slow_callback(rn_task_t *task, uint64_t duration)
+{
+	XTEST(task->function == slow_task);
+	XTEST(duration >= 20 * RN_TASK_TICK);
+	nbslow++;
+}
+
+/**
+ * Main function for this unit test.
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	rn_sched_t *sched;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(rn_stats_histograms(sched, true) == 0);
+	rn_stats_slowtask(sched, 10 * RN_TASK_TICK, slow_callback);
+	XTEST(rn_task_start(sched, slow_task, NULL) == 0);
+	XTEST(rn_task_start(sched, fast_task, sched) == 0);
+	rn_scheduler_loop(sched);
+	XTEST(nbslow == 1);
+	XTEST(sched->hist->runtime.count >= 3);
+	XTEST(sched->hist->runtime.max >= 20 * RN_TASK_TICK);
+	XTEST(rn_histogram_percentile(&sched->hist->runtime, 100) >= 20 * RN_TASK_TICK);
+	XTEST(sched->hist->lag.count == 1);
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
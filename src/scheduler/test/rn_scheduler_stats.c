@@ -0,0 +1,85 @@
+/**
+ * @file   rn_scheduler_stats.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Scheduler statistics unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define NBSPAWNS	2
+#define NBTASKS		10
+
+rn_sched_t *sched;
+
+void task_func(void *unused(arg))
+{
+	rn_sched_t *cur;
+
+	cur = rn_scheduler_self();
+	XTEST(rn_task_wait(cur, 10) == 0);
+	XTEST(rn_task_pause(cur) == 0);
+}
+
+void check_func(void *unused(arg))
+{
+	int i;
+	rn_sched_stats_t stats[NBSPAWNS + 2];
+
+	XTEST(rn_task_wait(sched, 100) == 0);
+	XTEST(rn_stats_snapshot(sched, stats, NBSPAWNS + 2) == NBSPAWNS + 1);
+	for (i = 0; i <= NBSPAWNS; i++) {
+		XTEST(stats[i].created >= NBTASKS);
+		XTEST(stats[i].destroyed >= NBTASKS);
+		XTEST(stats[i].timers >= NBTASKS);
+		XTEST(stats[i].switches >= NBTASKS * 3);
+		XTEST(stats[i].wakeups > 0);
+		XTEST(stats[i].poll_time > 0);
+	}
+	/* Only this task is still alive on the main scheduler */
+	XTEST(stats[0].live == 1);
+	XTEST(stats[1].live == 0);
+	rn_scheduler_stop(sched);
+}
+
+void start_func(void *unused(arg))
+{
+	int i;
+	rn_sched_t *cur;
+
+	cur = rn_scheduler_self();
+	for (i = 0; i < NBTASKS; i++) {
+		XTEST(rn_task_start(cur, task_func, NULL) == 0);
+	}
+}
+
+/**
+ * Main function for this unit test.
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	int i;
+	rn_sched_stats_t stats;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(rn_spawn(sched, NBSPAWNS) == 0);
+	rn_stats_looptime(sched, true);
+	for (i = 0; i <= NBSPAWNS; i++) {
+		rn_scheduler_keepalive(rn_spawn_get(sched, i), true);
+		XTEST(rn_task_start(rn_spawn_get(sched, i), start_func, NULL) == 0);
+	}
+	XTEST(rn_task_start(sched, check_func, NULL) == 0);
+	rn_scheduler_loop(sched);
+	rn_stats_get(sched, &stats);
+	XTEST(stats.created == NBTASKS + 2);
+	XTEST(stats.live == 0);
+	XTEST(stats.pending == 0);
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
@@ -0,0 +1,93 @@
+/**
+ * @file   rn_select.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Select unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+int fds[2];
+rn_sched_node_t node;
+rn_bchannel_t *bchannel;
+rn_bchannel_t *ack;
+rn_mchannel_t *mchannel;
+rn_mchannel_t *go;
+
+void feeder(void *unused(arg))
+{
+	XTEST(rn_bchannel_put(bchannel, (void *) 1) == 0);
+	XTEST(rn_bchannel_get(ack) != NULL);
+	XTEST(write(fds[1], "x", 1) == 1);
+	XTEST(rn_bchannel_get(ack) != NULL);
+}
+
+void remote_feeder(void *unused(arg))
+{
+	XTEST(rn_mchannel_get(go) != NULL);
+	XTEST(rn_mchannel_put(mchannel, (void *) 1) == 0);
+}
+
+void selector(void *sched)
+{
+	char c;
+	rn_select_t entries[3];
+
+	rn_select_node(&entries[0], &node, RN_MODE_IN);
+	rn_select_bchannel(&entries[1], bchannel, RN_MODE_IN);
+	rn_select_mchannel(&entries[2], mchannel, RN_MODE_IN);
+	XTEST(rn_select(sched, entries, 3, 1000) == 1);
+	XTEST(rn_bchannel_get(bchannel) != NULL);
+	XTEST(rn_bchannel_put(ack, (void *) 1) == 0);
+	XTEST(rn_select(sched, entries, 3, 1000) == 0);
+	XTEST(read(fds[0], &c, 1) == 1);
+	XTEST(rn_bchannel_put(ack, (void *) 1) == 0);
+	XTEST(rn_mchannel_put(go, (void *) 1) == 0);
+	XTEST(rn_select(sched, entries, 3, 1000) == 2);
+	XTEST(rn_mchannel_get(mchannel) != NULL);
+	/* Nothing left, select times out */
+	XTEST(rn_select(sched, entries, 3, 50) == -1);
+	XTEST(rn_error == ETIMEDOUT);
+	rn_scheduler_remove(&node);
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	rn_sched_t *sched;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(pipe2(fds, O_NONBLOCK) == 0);
+	node.fd = fds[0];
+	node.sched = sched;
+	bchannel = rn_bchannel(sched, 4);
+	XTEST(bchannel != NULL);
+	ack = rn_bchannel(sched, 1);
+	XTEST(ack != NULL);
+	mchannel = rn_mchannel(4);
+	XTEST(mchannel != NULL);
+	go = rn_mchannel(1);
+	XTEST(go != NULL);
+	XTEST(rn_spawn(sched, 1) == 0);
+	XTEST(rn_task_start(rn_spawn_get(sched, 1), remote_feeder, NULL) == 0);
+	XTEST(rn_task_start(sched, selector, sched) == 0);
+	XTEST(rn_task_start(sched, feeder, NULL) == 0);
+	rn_scheduler_loop(sched);
+	rn_scheduler_destroy(sched);
+	rn_bchannel_destroy(bchannel);
+	rn_bchannel_destroy(ack);
+	rn_mchannel_destroy(mchannel);
+	rn_mchannel_destroy(go);
+	close(fds[0]);
+	close(fds[1]);
+	XPASS();
+}
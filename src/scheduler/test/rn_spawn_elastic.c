@@ -0,0 +1,116 @@
+/**
+ * @file   rn_spawn_elastic.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Elastic spawn pool unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define NBYIELDERS	300
+
+int ran_on[4];
+bool busy = true;
+
+void where(void *unused(arg))
+{
+	__atomic_add_fetch(&ran_on[rn_scheduler_self()->id], 1, __ATOMIC_SEQ_CST);
+}
+
+void sleeper(void *unused(arg))
+{
+	rn_task_wait(rn_scheduler_self(), 200);
+}
+
+void yielder(void *sched)
+{
+	while (busy) {
+		rn_task_pause(sched);
+	}
+}
+
+int nbactive(rn_sched_t *sched)
+{
+	int i;
+	int count;
+	rn_sched_t *cur;
+
+	count = 0;
+	for (i = 1; i <= sched->spawns.count; i++) {
+		cur = rn_spawn_get(sched, i);
+		if (cur != NULL && !cur->draining) {
+			count++;
+		}
+	}
+	return count;
+}
+
+void wait_gone(rn_sched_t *sched, int id)
+{
+	int i;
+
+	for (i = 0; i < 100 && rn_spawn_get(sched, id) != NULL; i++) {
+		rn_task_wait(sched, 10);
+	}
+	XTEST(rn_spawn_get(sched, id) == NULL);
+}
+
+void controller(void *sched)
+{
+	int i;
+
+	/* Adding a spawn while running */
+	XTEST(rn_spawn_add(sched) == 2);
+	XTEST(rn_task_start_remote(rn_spawn_get(sched, 2), where, NULL) == 0);
+	rn_task_wait(sched, 50);
+	XTEST(ran_on[2] == 1);
+	/* Retiring it, its slot gets reused */
+	XTEST(rn_spawn_retire(sched, 2, 1000) == 0);
+	wait_gone(sched, 2);
+	XTEST(rn_spawn_add(sched) == 2);
+	/* New work of a retired spawn goes to its parent */
+	XTEST(rn_task_start_remote(rn_spawn_get(sched, 1), sleeper, NULL) == 0);
+	XTEST(rn_spawn_retire(sched, 1, 0) == 0);
+	XTEST(rn_task_start_remote(rn_spawn_get(sched, 1), where, NULL) == 0);
+	wait_gone(sched, 1);
+	XTEST(ran_on[0] == 1);
+	XTEST(ran_on[1] == 0);
+	/* Elastic pool grows under load */
+	XTEST(rn_spawn_elastic(sched, 1, 3, 10) == 0);
+	for (i = 0; i < NBYIELDERS; i++) {
+		XTEST(rn_task_start(sched, yielder, sched) == 0);
+	}
+	for (i = 0; i < 100 && nbactive(sched) < 3; i++) {
+		rn_task_wait(sched, 10);
+	}
+	XTEST(nbactive(sched) == 3);
+	busy = false;
+	/* and shrinks back once idle */
+	for (i = 0; i < 100 && nbactive(sched) > 1; i++) {
+		rn_task_wait(sched, 10);
+	}
+	XTEST(nbactive(sched) == 1);
+	rn_scheduler_stop(sched);
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	rn_sched_t *sched;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(rn_spawn_add(sched) == 1);
+	XTEST(rn_task_start(sched, controller, sched) == 0);
+	rn_scheduler_loop(sched);
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
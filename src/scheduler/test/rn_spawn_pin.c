@@ -0,0 +1,68 @@
+/**
+ * @file   rn_spawn_pin.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  rn_spawn_pin unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define NBSPAWNS	4
+
+int checker[NBSPAWNS + 1];
+
+void task(void *unused(arg))
+{
+	rn_sched_t *cur;
+	cpu_set_t cpuset;
+
+	cur = rn_scheduler_self();
+	XTEST(cur != NULL);
+	XTEST(cur->pinned == true);
+	XTEST(CPU_COUNT(&cur->cpuset) == 1);
+	XTEST(pthread_getaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) == 0);
+	XTEST(CPU_EQUAL(&cpuset, &cur->cpuset));
+	XTEST(cur->cpu == sched_getcpu());
+	XTEST(CPU_ISSET(cur->cpu, &cur->cpuset));
+	XTEST(cur->node >= 0);
+	checker[cur->id] = 1;
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	int i;
+	rn_sched_t *sched;
+	cpu_set_t cpuset;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(((uintptr_t) sched & (getpagesize() - 1)) == 0);
+	XTEST(sched->cpu == -1);
+	XTEST(rn_spawn(sched, NBSPAWNS) == 0);
+	CPU_ZERO(&cpuset);
+	XTEST(rn_spawn_affinity(sched, 1, &cpuset) == -1);
+	XTEST(rn_spawn_affinity(sched, NBSPAWNS + 1, &cpuset) == -1);
+	XTEST(rn_spawn_pin(sched) == 0);
+	XTEST(sched->pinned == false);
+	for (i = 1; i <= NBSPAWNS; i++) {
+		XTEST(rn_spawn_get(sched, i)->pinned == true);
+		XTEST(rn_task_start(rn_spawn_get(sched, i), task, NULL) == 0);
+	}
+	rn_scheduler_loop(sched);
+	XTEST(sched->cpu >= 0);
+	XTEST(sched->node >= 0);
+	rn_scheduler_destroy(sched);
+	for (i = 1; i <= NBSPAWNS; i++) {
+		XTEST(checker[i] == 1);
+	}
+	XPASS();
+}
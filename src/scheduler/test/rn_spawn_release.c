@@ -0,0 +1,49 @@
+/**
+ * @file   rn_spawn_release.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Spawns kept alive must end along with the main loop
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+int ran;
+
+void remote(void *unused(arg))
+{
+	rn_task_wait(rn_scheduler_self(), 50);
+	__atomic_add_fetch(&ran, 1, __ATOMIC_SEQ_CST);
+}
+
+void starter(void *sched)
+{
+	XTEST(rn_task_start_remote(rn_spawn_get(sched, 1), remote, NULL) == 0);
+	XTEST(rn_task_start_remote(rn_spawn_get(sched, 2), remote, NULL) == 0);
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	rn_sched_t *sched;
+
+	/* Fails instead of hanging if spawns are never released */
+	alarm(10);
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(rn_spawn_add(sched) == 1);
+	XTEST(rn_spawn_add(sched) == 2);
+	XTEST(rn_task_start(sched, starter, sched) == 0);
+	rn_scheduler_loop(sched);
+	/* Tasks already running on spawns are not cancelled */
+	XTEST(ran == 2);
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
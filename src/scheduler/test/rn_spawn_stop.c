@@ -19,8 +19,8 @@ void task(void *unused(arg))
 	rn_sched_t *cur;
 
 	rn_log("%s start %d", __FUNCTION__, rn_scheduler_self()->id);
-	/* sleep should return as soon as we get killed by the main scheduler */
-	sleep(1000);
+	/* Should return as soon as the main scheduler stops us */
+	rn_task_wait(rn_scheduler_self(), 1000000);
 	cur = rn_scheduler_self();
 	XTEST(cur != NULL);
 	XTEST(cur->id >= 0 && cur->id <= NBSPAWNS);
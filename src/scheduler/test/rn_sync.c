@@ -0,0 +1,106 @@
+/**
+ * @file   rn_sync.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Task synchronization unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define NBSPAWNS	2
+#define NBTASKS		4
+#define NBLOOPS		100
+
+int locked = 0;
+int limited = 0;
+int counter = 0;
+bool ready = false;
+rn_mutex_t mutex;
+rn_sem_t sem;
+rn_cond_t cond;
+rn_waitgroup_t wg;
+
+void worker(void *sched)
+{
+	int i;
+
+	for (i = 0; i < NBLOOPS; i++) {
+		XTEST(rn_mutex_lock(&mutex) == 0);
+		XTEST(__atomic_add_fetch(&locked, 1, __ATOMIC_SEQ_CST) == 1);
+		counter++;
+		rn_task_pause(sched);
+		__atomic_sub_fetch(&locked, 1, __ATOMIC_SEQ_CST);
+		rn_mutex_unlock(&mutex);
+		XTEST(rn_sem_wait(&sem) == 0);
+		XTEST(__atomic_add_fetch(&limited, 1, __ATOMIC_SEQ_CST) <= 2);
+		rn_task_pause(sched);
+		__atomic_sub_fetch(&limited, 1, __ATOMIC_SEQ_CST);
+		rn_sem_post(&sem);
+	}
+	rn_waitgroup_done(&wg);
+}
+
+void waiter(void *unused(arg))
+{
+	XTEST(rn_mutex_lock(&mutex) == 0);
+	while (!ready) {
+		XTEST(rn_cond_wait(&cond, &mutex) == 0);
+	}
+	/* Nobody signals anymore */
+	XTEST(rn_cond_timedwait(&cond, &mutex, 10) == -1);
+	XTEST(rn_error == ETIMEDOUT);
+	rn_mutex_unlock(&mutex);
+}
+
+void checker(void *unused(arg))
+{
+	XTEST(rn_waitgroup_wait(&wg) == 0);
+	XTEST(counter == (NBSPAWNS + 1) * NBTASKS * NBLOOPS);
+	XTEST(rn_mutex_trylock(&mutex) == 0);
+	XTEST(rn_mutex_trylock(&mutex) == -1);
+	ready = true;
+	rn_cond_broadcast(&cond);
+	rn_mutex_unlock(&mutex);
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	int i;
+	int j;
+	rn_sched_t *sched;
+	rn_sched_t *spawn;
+
+	XTEST(rn_mutex(&mutex) == 0);
+	XTEST(rn_sem(&sem, 2) == 0);
+	XTEST(rn_cond(&cond) == 0);
+	XTEST(rn_waitgroup(&wg) == 0);
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(rn_spawn(sched, NBSPAWNS) == 0);
+	rn_waitgroup_add(&wg, (NBSPAWNS + 1) * NBTASKS);
+	for (i = 0; i <= NBSPAWNS; i++) {
+		spawn = rn_spawn_get(sched, i);
+		for (j = 0; j < NBTASKS; j++) {
+			XTEST(rn_task_start(spawn, worker, spawn) == 0);
+		}
+	}
+	XTEST(rn_task_start(sched, waiter, NULL) == 0);
+	XTEST(rn_task_start(sched, checker, NULL) == 0);
+	rn_scheduler_loop(sched);
+	rn_scheduler_destroy(sched);
+	XTEST(sem.value == 2);
+	rn_mutex_destroy(&mutex);
+	rn_sem_destroy(&sem);
+	rn_cond_destroy(&cond);
+	rn_waitgroup_destroy(&wg);
+	XPASS();
+}
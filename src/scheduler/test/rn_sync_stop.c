@@ -0,0 +1,61 @@
+/**
+ * @file   rn_sync_stop.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Synchronization primitives unit test, woken while stopping
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+rn_sem_t sem;
+int waited = 0;
+pthread_t poster;
+
+void *post_func(void *unused(arg))
+{
+	/* Not a scheduler thread, the wakeup goes through the remote queue */
+	rn_sem_post(&sem);
+	return NULL;
+}
+
+void waiter_func(void *unused(arg))
+{
+	waited = rn_sem_wait(&sem);
+	XTEST(waited == -1);
+	XTEST(rn_error == ECANCELED);
+}
+
+void stop_func(void *sched)
+{
+	rn_scheduler_stop(sched);
+	XTEST(pthread_create(&poster, NULL, post_func, NULL) == 0);
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	rn_sched_t *sched;
+
+	XTEST(rn_sem(&sem, 0) == 0);
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(rn_task_start(sched, waiter_func, NULL) == 0);
+	XTEST(rn_task_start(sched, stop_func, sched) == 0);
+	rn_scheduler_loop(sched);
+	XTEST(pthread_join(poster, NULL) == 0);
+	/* The wakeup is delivered while destroying, the waiter gets cancelled */
+	rn_scheduler_destroy(sched);
+	XTEST(waited == -1);
+	/* The post handed over to the cancelled waiter is given back */
+	XTEST(rn_sem_trywait(&sem) == 0);
+	rn_sem_destroy(&sem);
+	XPASS();
+}
@@ -0,0 +1,82 @@
+/**
+ * @file   rn_task_offload.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Blocking call offloading unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define NBJOBS	8
+
+int ticks = 0;
+int nbdone = 0;
+
+int blocking(void *arg)
+{
+	usleep(20000);
+	if (arg == NULL) {
+		errno = ENOENT;
+		return -1;
+	}
+	return (int) (intptr_t) arg;
+}
+
+void offloader(void *arg)
+{
+	rn_sched_t *sched = rn_scheduler_self();
+
+	XTEST(rn_task_offload(sched, blocking, arg) == (int) (intptr_t) arg);
+	XTEST(rn_task_offload(sched, blocking, NULL) == -1);
+	XTEST(errno == ENOENT);
+	nbdone++;
+}
+
+void ticker(void *sched)
+{
+	while (nbdone < NBJOBS) {
+		ticks++;
+		rn_task_wait(sched, 1);
+	}
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	intptr_t i;
+	rn_sched_t *sched;
+	rn_offload_stats_t stats;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	/* Outside of a task, the function is called directly */
+	XTEST(rn_task_offload(sched, blocking, (void *) 42) == 42);
+	rn_offload_stats(sched, &stats);
+	XTEST(stats.jobs == 0);
+	XTEST(rn_offload_start(sched, 2) == 0);
+	XTEST(rn_offload_start(sched, 2) == -1);
+	for (i = 1; i <= NBJOBS; i++) {
+		XTEST(rn_task_start(sched, offloader, (void *) i) == 0);
+	}
+	XTEST(rn_task_start(sched, ticker, sched) == 0);
+	rn_scheduler_loop(sched);
+	XTEST(nbdone == NBJOBS);
+	/* The scheduler kept running while jobs were blocking */
+	XTEST(ticks > 10);
+	rn_offload_stats(sched, &stats);
+	XTEST(stats.jobs == NBJOBS * 2);
+	XTEST(stats.depth == 0);
+	XTEST(stats.max_depth > 2);
+	XTEST(stats.wait_time > 0);
+	XTEST(stats.run_time >= NBJOBS * 2 * 20000000ULL);
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
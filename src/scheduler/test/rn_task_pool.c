@@ -0,0 +1,67 @@
+/**
+ * @file   rn_task_pool.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  rn_task_pool unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define NBTASKS		20
+
+int checker = 0;
+
+void task(void *sched)
+{
+	checker++;
+	rn_task_pause(sched);
+	checker++;
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	int i;
+	rn_sched_t *sched;
+	rn_task_pool_stats_t stats;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(rn_task_pool_set(sched, 8, 4) == -1);
+	XTEST(rn_task_pool_set(sched, 4, 8) == 0);
+	rn_task_pool_stats(sched, &stats);
+	XTEST(stats.size == 4);
+	for (i = 0; i < NBTASKS; i++) {
+		XTEST(rn_task_start(sched, task, sched) == 0);
+	}
+	rn_scheduler_loop(sched);
+	XTEST(checker == NBTASKS * 2);
+	rn_task_pool_stats(sched, &stats);
+	XTEST(stats.hits == 4);
+	XTEST(stats.misses == NBTASKS - 4);
+	XTEST(stats.recycled == 8);
+	XTEST(stats.released == NBTASKS - 8);
+	XTEST(stats.size == 8);
+	for (i = 0; i < NBTASKS / 4; i++) {
+		XTEST(rn_task_start(sched, task, sched) == 0);
+	}
+	rn_scheduler_loop(sched);
+	XTEST(checker == NBTASKS * 2 + NBTASKS / 2);
+	rn_task_pool_stats(sched, &stats);
+	XTEST(stats.hits == 4 + NBTASKS / 4);
+	XTEST(stats.misses == NBTASKS - 4);
+	XTEST(stats.size == 8);
+	XTEST(rn_task_pool_set(sched, 0, 2) == 0);
+	rn_task_pool_stats(sched, &stats);
+	XTEST(stats.size == 2);
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
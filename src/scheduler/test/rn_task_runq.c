@@ -0,0 +1,57 @@
+/**
+ * @file   rn_task_runq.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Task driver run queue unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define NBTASKS		5
+
+int order[NBTASKS * 2];
+int nbrun = 0;
+
+void task(void *arg)
+{
+	int id = (intptr_t) arg;
+
+	order[nbrun++] = id;
+	rn_task_pause(rn_scheduler_self());
+	order[nbrun++] = id;
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	int i;
+	rn_sched_t *sched;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	for (i = 0; i < NBTASKS; i++) {
+		XTEST(rn_task_start(sched, task, (void *)(intptr_t) i) == 0);
+	}
+	XTEST(rn_task_driver_nbpending(sched) == NBTASKS);
+	XTEST(sched->driver.timers.size == 0);
+	/* Tasks pausing are only run again on the next iteration */
+	XTEST(rn_task_driver_run(sched) == 0);
+	XTEST(nbrun == NBTASKS);
+	XTEST(rn_task_driver_nbpending(sched) == NBTASKS);
+	XTEST(rn_task_driver_run(sched) == -1);
+	XTEST(nbrun == NBTASKS * 2);
+	for (i = 0; i < NBTASKS * 2; i++) {
+		XTEST(order[i] == i % NBTASKS);
+	}
+	XTEST(rn_task_driver_nbpending(sched) == 0);
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
@@ -0,0 +1,85 @@
+/**
+ * @file   rn_task_stack.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  rn_task_start_stack/rn_task_run_stack unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+#include <sys/wait.h>
+
+int checker = 0;
+
+void big_task(void *unused(arg))
+{
+	volatile char buffer[48 * 1024];
+
+	printf("%s start\n", __FUNCTION__);
+	memset((char *) buffer, 42, sizeof(buffer));
+	XTEST(buffer[sizeof(buffer) - 1] == 42);
+	checker++;
+	printf("%s end\n", __FUNCTION__);
+}
+
+void small_task(void *sched)
+{
+	printf("%s start\n", __FUNCTION__);
+	XTEST(rn_task_self()->context.stack.size == 8 * 1024);
+	XTEST(rn_task_run_stack(sched, big_task, sched, 64 * 1024) == 0);
+	checker++;
+	printf("%s end\n", __FUNCTION__);
+}
+
+__attribute__((noinline)) int recurse(int depth)
+{
+	volatile char buffer[256];
+
+	buffer[0] = depth;
+	if (depth == 0) {
+		return buffer[0];
+	}
+	return recurse(depth - 1) + buffer[0];
+}
+
+void overflow_task(void *unused(arg))
+{
+	recurse(1000);
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	int status;
+	pid_t pid;
+	rn_sched_t *sched;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(rn_task_start_stack(sched, small_task, sched, 5000) == 0);
+	XTEST(rn_task_start_stack(sched, big_task, sched, 64 * 1024) == 0);
+	rn_scheduler_loop(sched);
+	XTEST(checker == 3);
+	pid = fork();
+	XTEST(pid >= 0);
+	if (pid == 0) {
+		/* Overflowing a 4k stack must hit the guard page */
+		rn_task_run_stack(sched, overflow_task, NULL, 4096);
+		exit(0);
+	}
+	XTEST(waitpid(pid, &status, 0) == pid);
+	XTEST(WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV);
+	XTEST(rn_task_stack_set(sched, 8 * 1024) == 0);
+	XTEST(sched->driver.pool.stack_size == 8 * 1024);
+	XTEST(rn_task_run(sched, small_task, sched) == 0);
+	XTEST(checker == 5);
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
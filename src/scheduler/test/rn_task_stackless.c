@@ -0,0 +1,103 @@
+/**
+ * @file   rn_task_stackless.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Stackless task unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define NBREADERS	256
+
+typedef struct reader_s {
+	int fds[2];
+	char byte;
+	rn_sched_node_t node;
+} reader_t;
+
+int nbread = 0;
+int nbsteps = 0;
+int nberrors = 0;
+rn_sched_t *sched;
+reader_t readers[NBREADERS];
+
+void on_readable(void *arg)
+{
+	reader_t *reader = arg;
+
+	XTEST(rn_task_self()->stackless);
+	XTEST(reader->node.error == 0);
+	XTEST(read(reader->fds[0], &reader->byte, 1) == 1);
+	XTEST(reader->byte == 'x');
+	nbread++;
+}
+
+void on_error(void *arg)
+{
+	reader_t *reader = arg;
+
+	XTEST(reader->node.error == ECANCELED);
+	nberrors++;
+}
+
+void writer(void *unused(arg))
+{
+	int i;
+
+	XTEST(rn_task_wait(sched, 10) == 0);
+	XTEST(nbread == 0);
+	for (i = 0; i < NBREADERS; i++) {
+		XTEST(write(readers[i].fds[1], "x", 1) == 1);
+	}
+}
+
+void step(void *unused(arg))
+{
+	/* State machine being run again until its last step */
+	if (++nbsteps < 3) {
+		XTEST(rn_task_schedule(rn_task_self(), sched->clock + 5 * RN_TASK_TICK) == 0);
+	}
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	int i;
+	rn_sched_stats_t stats;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	for (i = 0; i < NBREADERS; i++) {
+		XTEST(pipe(readers[i].fds) == 0);
+		readers[i].node.fd = readers[i].fds[0];
+		readers[i].node.sched = sched;
+		XTEST(rn_scheduler_waitfor_cb(&readers[i].node, RN_MODE_IN, on_readable, &readers[i]) == 0);
+	}
+	XTEST(rn_task_start(sched, writer, NULL) == 0);
+	XTEST(rn_task_start_stackless(sched, step, NULL) == 0);
+	rn_scheduler_loop(sched);
+	XTEST(nbread == NBREADERS);
+	XTEST(nbsteps == 3);
+	/* Errors are reported to the callback */
+	readers[0].node.error = ECANCELED;
+	XTEST(rn_scheduler_waitfor_cb(&readers[0].node, RN_MODE_IN, on_error, &readers[0]) == 0);
+	rn_scheduler_loop(sched);
+	XTEST(nberrors == 1);
+	rn_stats_get(sched, &stats);
+	XTEST(stats.live == 0);
+	for (i = 0; i < NBREADERS; i++) {
+		rn_scheduler_remove(&readers[i].node);
+		close(readers[i].fds[0]);
+		close(readers[i].fds[1]);
+	}
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
@@ -0,0 +1,85 @@
+/**
+ * @file   rn_task_start_remote.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  rn_task_start_remote unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define NBSPAWNS	4
+#define NBTASKS		1000
+
+rn_sched_t *sched;
+int counter = 0;
+int checker[NBSPAWNS + 1];
+
+void remote_task(void *arg)
+{
+	rn_sched_t *cur;
+
+	cur = rn_scheduler_self();
+	XTEST(cur != NULL);
+	XTEST(cur->id == (intptr_t) arg);
+	__atomic_add_fetch(&checker[cur->id], 1, __ATOMIC_RELAXED);
+	if (__atomic_add_fetch(&counter, 1, __ATOMIC_RELAXED) == NBTASKS * 2) {
+		rn_scheduler_stop(sched);
+	}
+}
+
+void producer_task(void *unused(arg))
+{
+	int i;
+
+	printf("%s start\n", __FUNCTION__);
+	/* Give spawns time to get idle */
+	rn_task_wait(sched, 50);
+	for (i = 0; i < NBTASKS; i++) {
+		XTEST(rn_task_start_remote(rn_spawn_get(sched, 1 + i % NBSPAWNS), remote_task, (void *)(intptr_t)(1 + i % NBSPAWNS)) == 0);
+	}
+	printf("%s end\n", __FUNCTION__);
+}
+
+void *producer_thread(void *unused(arg))
+{
+	int i;
+
+	usleep(50000);
+	for (i = 0; i < NBTASKS; i++) {
+		XTEST(rn_task_start_remote(sched, remote_task, (void *) 0) == 0);
+	}
+	return NULL;
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	int i;
+	pthread_t thread;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(rn_spawn(sched, NBSPAWNS) == 0);
+	for (i = 0; i <= NBSPAWNS; i++) {
+		rn_scheduler_keepalive(rn_spawn_get(sched, i), true);
+	}
+	XTEST(rn_task_start(sched, producer_task, NULL) == 0);
+	XTEST(pthread_create(&thread, NULL, producer_thread, NULL) == 0);
+	rn_scheduler_loop(sched);
+	XTEST(pthread_join(thread, NULL) == 0);
+	rn_scheduler_destroy(sched);
+	XTEST(counter == NBTASKS * 2);
+	XTEST(checker[0] == NBTASKS);
+	for (i = 1; i <= NBSPAWNS; i++) {
+		XTEST(checker[i] == NBTASKS / NBSPAWNS);
+	}
+	XPASS();
+}
@@ -0,0 +1,93 @@
+/**
+ * @file   rn_task_steal.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Work stealing unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define NBSPAWNS	3
+#define NBTASKS		200
+
+extern const rn_socket_class_t socket_class_tcp;
+
+int counter = 0;
+int socket_runner = -1;
+int checker[NBSPAWNS + 1];
+
+void busy_task(void *unused(arg))
+{
+	int i;
+	rn_sched_t *cur;
+	volatile int dummy = 0;
+
+	cur = rn_scheduler_self();
+	XTEST(cur != NULL);
+	XTEST(rn_task_self()->sched == cur);
+	for (i = 0; i < 200000; i++) {
+		dummy++;
+	}
+	/* Tasks can yield once started, they stay on the same scheduler */
+	rn_task_pause(cur);
+	XTEST(rn_scheduler_self() == cur);
+	__atomic_add_fetch(&checker[cur->id], 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&counter, 1, __ATOMIC_RELAXED);
+}
+
+void socket_task(void *arg)
+{
+	rn_socket_t *socket = arg;
+
+	XTEST(rn_socket_migrate(rn_scheduler_self(), socket) == 0);
+	XTEST(socket->node.sched == rn_scheduler_self());
+	rn_socket_destroy(socket);
+	socket_runner = rn_scheduler_self()->id;
+	__atomic_add_fetch(&counter, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	int i;
+	int nbstolen;
+	rn_sched_t *sched;
+	rn_socket_t *socket;
+	rn_steal_stats_t stats;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(rn_spawn(sched, NBSPAWNS) == 0);
+	XTEST(rn_steal_set(sched, true) == 0);
+	for (i = 0; i <= NBSPAWNS; i++) {
+		XTEST(rn_spawn_get(sched, i)->steal.enabled == true);
+	}
+	for (i = 0; i < NBTASKS; i++) {
+		XTEST(rn_task_start_stealable(sched, busy_task, NULL) == 0);
+	}
+	socket = rn_socket(sched, &socket_class_tcp);
+	XTEST(socket != NULL);
+	XTEST(rn_task_start_stealable(sched, socket_task, socket) == 0);
+	rn_scheduler_loop(sched);
+	XTEST(counter == NBTASKS + 1);
+	nbstolen = (socket_runner != 0 ? 1 : 0);
+	for (i = 1; i <= NBSPAWNS; i++) {
+		nbstolen += checker[i];
+	}
+	XTEST(checker[0] + nbstolen - (socket_runner != 0 ? 1 : 0) == NBTASKS);
+	rn_steal_stats(sched, &stats);
+	rn_log("tasks run by main: %d, stolen: %d, failed steals: %lu", checker[0], nbstolen, stats.failed);
+	XTEST(stats.stolen == 0);
+	XTEST(stats.given == (uint64_t) nbstolen);
+	XTEST(nbstolen > 0);
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
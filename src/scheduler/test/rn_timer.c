@@ -0,0 +1,73 @@
+/**
+ * @file   rn_timer.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Callback timer unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+int nbticks = 0;
+int nbonce = 0;
+int nbstopped = 0;
+rn_sched_t *sched;
+rn_timer_t *periodic;
+
+void tick(void *unused(arg))
+{
+	XTEST(rn_task_self() == &sched->driver.main);
+	if (++nbticks == 5) {
+		/* Stopping a timer from its own function */
+		rn_timer_stop(sched, periodic);
+	}
+}
+
+void once(void *arg)
+{
+	nbonce++;
+	XTEST(arg == &nbonce);
+}
+
+void never(void *unused(arg))
+{
+	nbstopped++;
+}
+
+void task(void *unused(arg))
+{
+	rn_timer_t *timer;
+
+	periodic = rn_timer_start(sched, 10, true, tick, NULL);
+	XTEST(periodic != NULL);
+	XTEST(rn_timer_start(sched, 5, false, once, &nbonce) != NULL);
+	timer = rn_timer_start(sched, 5, false, never, NULL);
+	XTEST(timer != NULL);
+	rn_timer_stop(sched, timer);
+	XTEST(rn_task_wait(sched, 100) == 0);
+	XTEST(nbticks == 5);
+	XTEST(nbonce == 1);
+	/* Callback timers don't keep the scheduler running */
+	XTEST(rn_timer_start(sched, 100000, true, never, NULL) != NULL);
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	XTEST(rn_task_start(sched, task, NULL) == 0);
+	rn_scheduler_loop(sched);
+	XTEST(sched->driver.nbtimers == 1);
+	rn_scheduler_destroy(sched);
+	XTEST(nbticks == 5);
+	XTEST(nbstopped == 0);
+	XPASS();
+}
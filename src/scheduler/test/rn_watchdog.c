@@ -0,0 +1,88 @@
+/**
+ * @file   rn_watchdog.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Scheduler watchdog unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+int nbreports = 0;
+rn_watchdog_report_t last;
+
+uint64_t now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void busy(uint64_t ms)
+{
+	uint64_t end;
+
+	end = now() + ms * 1000000;
+	while (now() < end);
+}
+
+void on_stall(rn_watchdog_report_t *report)
+{
+	rn_sched_stats_t stats;
+
+	/* No scheduler lock is held while reporting */
+	XTEST(rn_stats_snapshot(report->sched, &stats, 1) == 1);
+	last = *report;
+	__atomic_add_fetch(&nbreports, 1, __ATOMIC_SEQ_CST);
+}
+
+void hog(void *unused(arg))
+{
+	busy(300);
+}
+
+void polite(void *sched)
+{
+	int i;
+
+	for (i = 0; i < 10; i++) {
+		busy(10);
+		XTEST(rn_task_wait(sched, 1) == 0);
+	}
+	/* Time spent before each wait is accounted */
+	XTEST(rn_task_self()->cputime >= 100 * 1000000ULL);
+}
+
+/**
+ * Main function for this unit test
+ *
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	rn_sched_t *sched;
+
+	sched = rn_scheduler();
+	XTEST(sched != NULL);
+	rn_stats_cputime(sched, true);
+	XTEST(rn_watchdog_start(sched, 100, on_stall) == 0);
+	XTEST(rn_watchdog_start(sched, 100, on_stall) == -1);
+	XTEST(rn_task_start(sched, polite, sched) == 0);
+	rn_scheduler_loop(sched);
+	XTEST(nbreports == 0);
+	XTEST(rn_task_start(sched, hog, NULL) == 0);
+	rn_scheduler_loop(sched);
+	/* Reports are made from the watchdog thread */
+	usleep(100000);
+	XTEST(nbreports == 1);
+	XTEST(last.sched == sched);
+	XTEST(last.function == hog);
+	XTEST(last.duration >= 100 * 1000000ULL);
+	XTEST(last.nbframes > 0);
+	rn_scheduler_destroy(sched);
+	XPASS();
+}
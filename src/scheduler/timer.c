@@ -0,0 +1,102 @@
+/**
+ * @file   timer.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Callback timer functions
+ *
+ *
+ */
+
+#include "rinoo/scheduler/module.h"
+
+/**
+ * Starts a callback timer. The function is run on the scheduler main
+ * context, not in a task, so it must not block or wait.
+ * Callback timers don't keep a scheduler running, and pending
+ * timers are released when the scheduler stops.
+ * A one-shot timer is released once its function returns.
+ *
+ * @param sched Pointer to the scheduler to use
+ * @param ms Time before expiry in ms, also the period of a periodic timer
+ * @param periodic Whether the timer is rearmed after each expiry
+ * @param function Function to run on expiry
+ * @param arg Function argument
+ *
+ * @return Pointer to the timer, or NULL if an error occurs
+ */
+rn_timer_t *rn_timer_start(rn_sched_t *sched, uint32_t ms, bool periodic, void (*function)(void *arg), void *arg)
+{
+	rn_timer_t *timer;
+
+	XASSERT(sched != NULL, NULL);
+	XASSERT(function != NULL, NULL);
+	XASSERT(ms > 0 || !periodic, NULL);
+
+	timer = calloc(1, sizeof(*timer));
+	if (timer == NULL) {
+		return NULL;
+	}
+	timer->period = (periodic ? (RN_MS_TO_NS(ms) + RN_TASK_TICK - 1) / RN_TASK_TICK : 0);
+	timer->arg = arg;
+	timer->function = function;
+	rn_wheel_put(&sched->driver.timers, &timer->node, (sched->clock + RN_MS_TO_NS(ms) + RN_TASK_TICK - 1) / RN_TASK_TICK);
+	sched->driver.nbtimers++;
+	return timer;
+}
+
+/**
+ * Stops a callback timer and releases it.
+ * This can be called from the timer function itself, but not on
+ * a one-shot timer which has already expired.
+ *
+ * @param sched Pointer to the scheduler running the timer
+ * @param timer Pointer to the timer to stop
+ */
+void rn_timer_stop(rn_sched_t *sched, rn_timer_t *timer)
+{
+	XASSERTN(sched != NULL);
+	XASSERTN(timer != NULL);
+
+	if (timer->running) {
+		/* Released by rn_timer_run once the function returns */
+		timer->function = NULL;
+		return;
+	}
+	if (timer->node.slot != NULL) {
+		rn_wheel_remove(&sched->driver.timers, &timer->node);
+		sched->driver.nbtimers--;
+	}
+	free(timer);
+}
+
+/**
+ * Runs an expired callback timer, and rearms it if it is periodic.
+ * Late periodic timers skip missed expiries.
+ *
+ * @param sched Pointer to the scheduler running the timer
+ * @param timer Pointer to the expired timer
+ */
+void rn_timer_run(rn_sched_t *sched, rn_timer_t *timer)
+{
+	uint64_t now;
+	uint64_t expire;
+
+	XASSERTN(sched != NULL);
+	XASSERTN(timer != NULL);
+
+	timer->running = true;
+	timer->function(timer->arg);
+	timer->running = false;
+	if (timer->function == NULL || timer->period == 0) {
+		free(timer);
+		return;
+	}
+	now = sched->clock / RN_TASK_TICK;
+	expire = timer->node.expire + timer->period;
+	if (expire <= now) {
+		expire = now + timer->period;
+	}
+	rn_wheel_put(&sched->driver.timers, &timer->node, expire);
+	sched->driver.nbtimers++;
+}
@@ -0,0 +1,619 @@
+/**
+ * @file   uring.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  This file manages the poll API working with io_uring.
+ *
+ *
+ */
+
+#include "rinoo/scheduler/module.h"
+
+#ifdef RINOO_IO_URING
+
+#include <poll.h>
+#include <linux/io_uring.h>
+
+#define RN_URING_NOSLOT		UINT32_MAX
+/* Completions of IO operations carry the operation address with the top bit set */
+#define RN_URING_OP			(1ULL << 63)
+#define RN_URING_GEN(gen)		((gen) & 0x7fffffff)
+#define RN_URING_DATA(uring, slot)	(((uint64_t) RN_URING_GEN((uring)->slots[slot].gen) << 32) | ((slot) + 1))
+
+const rn_poller_class_t rn_poller_uring = {
+	.name = "io_uring",
+	.init = rn_uring_init,
+	.destroy = rn_uring_destroy,
+	.insert = rn_uring_insert,
+	.addmode = rn_uring_addmode,
+	.remove = rn_uring_remove,
+	.poll = rn_uring_poll
+};
+
+static inline int rn_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags, void *arg, size_t argsz)
+{
+	return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+/**
+ * Converts a scheduler mode to poll events.
+ *
+ * @param mode Scheduler mode
+ *
+ * @return Poll events
+ */
+static uint32_t rn_uring_events(rn_sched_mode_t mode)
+{
+	uint32_t events = POLLRDHUP;
+
+	if ((mode & RN_MODE_IN) == RN_MODE_IN) {
+		events |= POLLIN;
+	}
+	if ((mode & RN_MODE_OUT) == RN_MODE_OUT) {
+		events |= POLLOUT;
+	}
+	return events;
+}
+
+/**
+ * Submits all queued requests.
+ *
+ * @param uring Pointer to the io_uring to use
+ *
+ * @return 0 on success, otherwise -1
+ */
+static int rn_uring_submit(rn_uring_t *uring)
+{
+	while (uring->nbpending > 0) {
+		if (rn_uring_enter(uring->fd, uring->nbpending, 0, 0, NULL, 0) < 0 && errno != EINTR) {
+			return -1;
+		}
+		uring->nbpending = *uring->sq_tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE);
+	}
+	return 0;
+}
+
+/**
+ * Gets a free submission queue entry.
+ * Queued requests are submitted if the submission queue is full.
+ *
+ * @param uring Pointer to the io_uring to use
+ *
+ * @return Pointer to a cleared entry, or NULL if an error occurs
+ */
+static struct io_uring_sqe *rn_uring_sqe(rn_uring_t *uring)
+{
+	uint32_t index;
+	struct io_uring_sqe *sqe;
+
+	if (*uring->sq_tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE) >= uring->sq_entries) {
+		if (rn_uring_submit(uring) != 0) {
+			return NULL;
+		}
+	}
+	index = *uring->sq_tail & *uring->sq_mask;
+	sqe = &((struct io_uring_sqe *) uring->sqes)[index];
+	memset(sqe, 0, sizeof(*sqe));
+	uring->sq_array[index] = index;
+	return sqe;
+}
+
+/**
+ * Queues the entry returned by the last rn_uring_sqe call.
+ *
+ * @param uring Pointer to the io_uring to use
+ */
+static void rn_uring_queue(rn_uring_t *uring)
+{
+	__atomic_store_n(uring->sq_tail, *uring->sq_tail + 1, __ATOMIC_RELEASE);
+	uring->nbpending++;
+}
+
+/**
+ * Gets a free registration slot, growing the slot table if needed.
+ *
+ * @param uring Pointer to the io_uring to use
+ *
+ * @return Slot index, or RN_URING_NOSLOT if an error occurs
+ */
+static uint32_t rn_uring_slot_get(rn_uring_t *uring)
+{
+	uint32_t i;
+	uint32_t slot;
+	uint32_t nbslots;
+	rn_uring_slot_t *slots;
+
+	if (uring->freeslot == RN_URING_NOSLOT) {
+		nbslots = (uring->nbslots == 0 ? RN_URING_ENTRIES : uring->nbslots * 2);
+		slots = realloc(uring->slots, sizeof(*slots) * nbslots);
+		if (slots == NULL) {
+			return RN_URING_NOSLOT;
+		}
+		for (i = uring->nbslots; i < nbslots; i++) {
+			slots[i].gen = 0;
+			slots[i].node = NULL;
+			slots[i].next = (i + 1 < nbslots ? i + 1 : RN_URING_NOSLOT);
+		}
+		uring->freeslot = uring->nbslots;
+		uring->nbslots = nbslots;
+		uring->slots = slots;
+	}
+	slot = uring->freeslot;
+	uring->freeslot = uring->slots[slot].next;
+	return slot;
+}
+
+/**
+ * Releases a registration slot.
+ * Its generation is increased so that pending completions get dropped.
+ *
+ * @param uring Pointer to the io_uring to use
+ * @param slot Slot index
+ */
+static void rn_uring_slot_put(rn_uring_t *uring, uint32_t slot)
+{
+	uring->slots[slot].gen++;
+	uring->slots[slot].node = NULL;
+	uring->slots[slot].next = uring->freeslot;
+	uring->freeslot = slot;
+}
+
+/**
+ * Queues a multishot poll request for a slot.
+ *
+ * @param uring Pointer to the io_uring to use
+ * @param slot Slot index
+ *
+ * @return 0 on success, otherwise -1
+ */
+static int rn_uring_arm(rn_uring_t *uring, uint32_t slot)
+{
+	struct io_uring_sqe *sqe;
+
+	sqe = rn_uring_sqe(uring);
+	if (sqe == NULL) {
+		return -1;
+	}
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = uring->slots[slot].node->fd;
+	sqe->poll32_events = uring->slots[slot].events;
+	sqe->len = IORING_POLL_ADD_MULTI;
+	sqe->user_data = RN_URING_DATA(uring, slot);
+	rn_uring_queue(uring);
+	return 0;
+}
+
+/**
+ * Queues the cancellation of a poll request.
+ *
+ * @param uring Pointer to the io_uring to use
+ * @param data User data of the request to cancel
+ *
+ * @return 0 on success, otherwise -1
+ */
+static int rn_uring_disarm(rn_uring_t *uring, uint64_t data)
+{
+	struct io_uring_sqe *sqe;
+
+	sqe = rn_uring_sqe(uring);
+	if (sqe == NULL) {
+		return -1;
+	}
+	sqe->opcode = IORING_OP_POLL_REMOVE;
+	sqe->fd = -1;
+	sqe->addr = data;
+	sqe->user_data = 0;
+	rn_uring_queue(uring);
+	return 0;
+}
+
+/**
+ * Queues the cancellation of an IO operation.
+ *
+ * @param uring Pointer to the io_uring to use
+ * @param op Pointer to the operation to cancel
+ *
+ * @return 0 on success, otherwise -1
+ */
+static int rn_uring_cancel(rn_uring_t *uring, rn_uring_op_t *op)
+{
+	struct io_uring_sqe *sqe;
+
+	sqe = rn_uring_sqe(uring);
+	if (sqe == NULL) {
+		return -1;
+	}
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = -1;
+	sqe->addr = (uint64_t)(uintptr_t) op | RN_URING_OP;
+	sqe->user_data = 0;
+	rn_uring_queue(uring);
+	op->cancel = true;
+	return 0;
+}
+
+/**
+ * io_uring initialization. It calls io_uring_setup and maps rings.
+ * Kernels without IORING_FEAT_EXT_ARG are not supported.
+ *
+ * @param sched Pointer to the scheduler to use.
+ *
+ * @return 0 if succeeds, else -1.
+ */
+int rn_uring_init(rn_sched_t *sched)
+{
+	rn_uring_t *uring;
+	struct io_uring_params params;
+
+	XASSERT(sched != NULL, -1);
+
+	uring = &sched->uring;
+	memset(uring, 0, sizeof(*uring));
+	rn_list(&uring->ops, NULL);
+	memset(&params, 0, sizeof(params));
+	params.flags = IORING_SETUP_CQSIZE;
+	params.cq_entries = RN_URING_ENTRIES * 16;
+	uring->fd = syscall(__NR_io_uring_setup, RN_URING_ENTRIES, &params);
+	if (uring->fd < 0) {
+		uring->fd = -1;
+		return -1;
+	}
+	if ((params.features & IORING_FEAT_EXT_ARG) == 0 || (params.features & IORING_FEAT_NODROP) == 0) {
+		rn_error_set(ENOTSUP);
+		goto uring_error;
+	}
+	uring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	uring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+		if (uring->cq_ring_size > uring->sq_ring_size) {
+			uring->sq_ring_size = uring->cq_ring_size;
+		}
+		uring->cq_ring_size = 0;
+	}
+	uring->sq_ring = mmap(NULL, uring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQ_RING);
+	if (uring->sq_ring == MAP_FAILED) {
+		uring->sq_ring = NULL;
+		goto uring_error;
+	}
+	uring->cq_ring = uring->sq_ring;
+	if (uring->cq_ring_size > 0) {
+		uring->cq_ring = mmap(NULL, uring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_CQ_RING);
+		if (uring->cq_ring == MAP_FAILED) {
+			uring->cq_ring = NULL;
+			goto uring_error;
+		}
+	}
+	uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	uring->sqes = mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->fd, IORING_OFF_SQES);
+	if (uring->sqes == MAP_FAILED) {
+		uring->sqes = NULL;
+		goto uring_error;
+	}
+	uring->sq_head = uring->sq_ring + params.sq_off.head;
+	uring->sq_tail = uring->sq_ring + params.sq_off.tail;
+	uring->sq_mask = uring->sq_ring + params.sq_off.ring_mask;
+	uring->sq_array = uring->sq_ring + params.sq_off.array;
+	uring->cq_head = uring->cq_ring + params.cq_off.head;
+	uring->cq_tail = uring->cq_ring + params.cq_off.tail;
+	uring->cq_mask = uring->cq_ring + params.cq_off.ring_mask;
+	uring->cqes = uring->cq_ring + params.cq_off.cqes;
+	uring->sq_entries = params.sq_entries;
+	uring->freeslot = RN_URING_NOSLOT;
+	return 0;
+uring_error:
+	rn_uring_destroy(sched);
+	return -1;
+}
+
+/**
+ * Destroys the io_uring poller in a scheduler. Unmaps rings and closes the io_uring fd.
+ *
+ * @param sched Pointer to the scheduler to use.
+ */
+void rn_uring_destroy(rn_sched_t *sched)
+{
+	rn_uring_t *uring;
+
+	XASSERTN(sched != NULL);
+
+	uring = &sched->uring;
+	if (uring->sqes != NULL) {
+		munmap(uring->sqes, uring->sqes_size);
+	}
+	if (uring->cq_ring != NULL && uring->cq_ring != uring->sq_ring) {
+		munmap(uring->cq_ring, uring->cq_ring_size);
+	}
+	if (uring->sq_ring != NULL) {
+		munmap(uring->sq_ring, uring->sq_ring_size);
+	}
+	if (uring->fd != -1) {
+		close(uring->fd);
+	}
+	free(uring->slots);
+	memset(uring, 0, sizeof(*uring));
+	uring->fd = -1;
+}
+
+/**
+ * Registers a node in io_uring. The poll request is only queued
+ * and gets submitted on the next poll, along with other requests.
+ *
+ * @param node Scheduler node to add.
+ * @param mode Polling mode to use to add.
+ *
+ * @return 0 if succeeds, else -1.
+ */
+int rn_uring_insert(rn_sched_node_t *node, rn_sched_mode_t mode)
+{
+	uint32_t slot;
+	rn_uring_t *uring;
+
+	uring = &node->sched->uring;
+	slot = rn_uring_slot_get(uring);
+	if (unlikely(slot == RN_URING_NOSLOT)) {
+		return -1;
+	}
+	uring->slots[slot].node = node;
+	uring->slots[slot].events = rn_uring_events(mode);
+	if (unlikely(rn_uring_arm(uring, slot) != 0)) {
+		rn_uring_slot_put(uring, slot);
+		return -1;
+	}
+	node->token = slot + 1;
+	return 0;
+}
+
+/**
+ * Changes the polling modes of a node registered in io_uring.
+ * The current poll request is cancelled and a new one is queued.
+ *
+ * @param node Scheduler node to update.
+ * @param mode Polling modes to use.
+ *
+ * @return 0 if succeeds, else -1.
+ */
+int rn_uring_addmode(rn_sched_node_t *node, rn_sched_mode_t mode)
+{
+	uint32_t slot;
+	rn_uring_t *uring;
+
+	XASSERT(node->token != 0, -1);
+
+	uring = &node->sched->uring;
+	slot = node->token - 1;
+	if (unlikely(rn_uring_disarm(uring, RN_URING_DATA(uring, slot)) != 0)) {
+		return -1;
+	}
+	uring->slots[slot].gen++;
+	uring->slots[slot].events = rn_uring_events(mode);
+	return rn_uring_arm(uring, slot);
+}
+
+/**
+ * Removes a node from io_uring.
+ *
+ * @param node Scheduler node to remove.
+ *
+ * @return 0 if succeeds, else -1.
+ */
+int rn_uring_remove(rn_sched_node_t *node)
+{
+	uint32_t slot;
+	rn_uring_t *uring;
+
+	if (node->token == 0) {
+		return -1;
+	}
+	uring = &node->sched->uring;
+	slot = node->token - 1;
+	node->token = 0;
+	if (unlikely(rn_uring_disarm(uring, RN_URING_DATA(uring, slot)) != 0)) {
+		rn_uring_slot_put(uring, slot);
+		return -1;
+	}
+	rn_uring_slot_put(uring, slot);
+	return 0;
+}
+
+/**
+ * Start polling. Queued requests are submitted and completions are
+ * waited for with a single io_uring_enter call.
+ *
+ * @param sched Pointer to the scheduler to use.
+ * @param timeout Maximum time to wait in milliseconds (-1 for no timeout)
+ *
+ * @return Number of events received.
+ */
+int rn_uring_poll(rn_sched_t *sched, int timeout)
+{
+	int res;
+	int nbevents;
+	size_t argsz;
+	uint32_t slot;
+	uint32_t head;
+	uint32_t flags;
+	uint32_t cflags;
+	uint64_t data;
+	unsigned int wait;
+	rn_uring_t *uring;
+	rn_uring_op_t *op;
+	rn_sched_node_t *node;
+	struct io_uring_cqe *cqe;
+	struct __kernel_timespec ts;
+	struct io_uring_getevents_arg arg;
+
+	XASSERT(sched != NULL, -1);
+
+	uring = &sched->uring;
+	wait = 0;
+	argsz = 0;
+	flags = IORING_ENTER_GETEVENTS;
+	if (timeout != 0 && *uring->cq_head == __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE)) {
+		wait = 1;
+		if (timeout > 0) {
+			ts.tv_sec = timeout / 1000;
+			ts.tv_nsec = RN_MS_TO_NS(timeout % 1000);
+			memset(&arg, 0, sizeof(arg));
+			arg.ts = (uint64_t)(uintptr_t) &ts;
+			argsz = sizeof(arg);
+			flags |= IORING_ENTER_EXT_ARG;
+		}
+	}
+	rn_uring_enter(uring->fd, uring->nbpending, wait, flags, (argsz > 0 ? &arg : NULL), argsz);
+	uring->nbpending = *uring->sq_tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE);
+	rn_scheduler_clock_update(sched);
+	nbevents = 0;
+	head = *uring->cq_head;
+	while (head != __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE)) {
+		cqe = &((struct io_uring_cqe *) uring->cqes)[head & *uring->cq_mask];
+		data = cqe->user_data;
+		res = cqe->res;
+		cflags = cqe->flags;
+		head++;
+		__atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+		if (data == 0) {
+			continue;
+		}
+		if ((data & RN_URING_OP) != 0) {
+			op = (rn_uring_op_t *)(uintptr_t) (data & ~RN_URING_OP);
+			op->res = res;
+			op->done = true;
+			rn_list_remove(&uring->ops, &op->node);
+			nbevents++;
+			/* Resumed like on a readiness event, a timeout set on the task stays armed */
+			rn_task_resume(op->task);
+			head = *uring->cq_head;
+			continue;
+		}
+		slot = (uint32_t) data - 1;
+		if (slot >= uring->nbslots || RN_URING_GEN(uring->slots[slot].gen) != (data >> 32) || uring->slots[slot].node == NULL) {
+			/* Node has been removed */
+			continue;
+		}
+		node = uring->slots[slot].node;
+		nbevents++;
+		if ((cflags & IORING_CQE_F_MORE) == 0 && res != -ECANCELED) {
+			/* Multishot request is over, it needs to be armed again */
+			rn_uring_arm(uring, slot);
+		}
+		if (res < 0) {
+			if (res != -ECANCELED) {
+				rn_scheduler_wakeup(node, RN_MODE_NONE, -res);
+			}
+			continue;
+		}
+		/* Check node after each wakeup as a resumed task could remove it */
+		if ((res & POLLIN) == POLLIN) {
+			rn_scheduler_wakeup(node, RN_MODE_IN, 0);
+		}
+		if ((res & POLLOUT) == POLLOUT && RN_URING_GEN(uring->slots[slot].gen) == (data >> 32)) {
+			rn_scheduler_wakeup(node, RN_MODE_OUT, 0);
+		}
+		if ((res & (POLLERR | POLLHUP)) != 0 && RN_URING_GEN(uring->slots[slot].gen) == (data >> 32)) {
+			rn_scheduler_wakeup(node, RN_MODE_NONE, ECONNRESET);
+		}
+		head = *uring->cq_head;
+	}
+	return nbevents;
+}
+
+/**
+ * Cancels the IO operations in flight and waits for them to complete.
+ * This is used once the scheduler has stopped, as operations reference
+ * task stacks, before tasks are destroyed.
+ *
+ * @param sched Pointer to the scheduler to use.
+ */
+void rn_uring_flush(rn_sched_t *sched)
+{
+	rn_uring_t *uring;
+	rn_uring_op_t *op;
+	rn_list_node_t *lnode;
+
+	XASSERTN(sched != NULL);
+	XASSERTN(sched->stop == true);
+
+	uring = &sched->uring;
+	while (rn_list_size(&uring->ops) > 0) {
+		for (lnode = rn_list_head(&uring->ops); lnode != NULL; lnode = lnode->next) {
+			op = container_of(lnode, rn_uring_op_t, node);
+			if (!op->cancel && rn_uring_cancel(uring, op) != 0) {
+				break;
+			}
+		}
+		rn_uring_poll(sched, -1);
+	}
+}
+
+/**
+ * Runs an IO operation through io_uring. The current task is
+ * suspended until the operation completes. The request is
+ * submitted on the next poll, along with other requests.
+ * If the task is resumed before completion, by a timeout or because
+ * the scheduler stops, the operation is cancelled.
+ *
+ * @param sched Pointer to the scheduler running the current task, using the io_uring poller
+ * @param opcode io_uring operation
+ * @param fd File descriptor
+ * @param addr Operation address (buffer, path)
+ * @param len Operation length (buffer size, file mode)
+ * @param offset File offset
+ * @param flags Operation flags (open flags, fsync flags)
+ *
+ * @return The operation result, or -1 if an error occurs (ETIMEDOUT on timeout, ECANCELED if the scheduler is stopping)
+ */
+int rn_uring_io(rn_sched_t *sched, uint8_t opcode, int fd, const void *addr, uint32_t len, uint64_t offset, uint32_t flags)
+{
+	rn_uring_op_t op;
+	struct io_uring_sqe *sqe;
+
+	XASSERT(sched != NULL, -1);
+	XASSERT(sched->poller == &rn_poller_uring, -1);
+
+	op.done = false;
+	op.cancel = false;
+	op.task = rn_task_driver_getcurrent(sched);
+	if (op.task == &sched->driver.main) {
+		rn_error_set(EINVAL);
+		return -1;
+	}
+	if (sched->stop) {
+		rn_error_set(ECANCELED);
+		return -1;
+	}
+	sqe = rn_uring_sqe(&sched->uring);
+	if (sqe == NULL) {
+		return -1;
+	}
+	sqe->opcode = opcode;
+	sqe->fd = fd;
+	sqe->addr = (uint64_t)(uintptr_t) addr;
+	sqe->len = len;
+	sqe->off = offset;
+	sqe->rw_flags = flags;
+	sqe->user_data = (uint64_t)(uintptr_t) &op | RN_URING_OP;
+	rn_uring_queue(&sched->uring);
+	rn_list_append(&sched->uring.ops, &op.node);
+	sched->nbpending++;
+	/* The operation lives in the task stack, the task can't go before it completes */
+	while (!op.done) {
+		rn_task_release(sched);
+		if (!op.done && !op.cancel) {
+			rn_uring_cancel(&sched->uring, &op);
+		}
+	}
+	sched->nbpending--;
+	if (op.res < 0) {
+		if (op.res == -ECANCELED && !sched->stop) {
+			/* Cancelled as the task has been resumed by its timer */
+			rn_error_set(ETIMEDOUT);
+		} else {
+			rn_error_set(-op.res);
+		}
+		return -1;
+	}
+	return op.res;
+}
+
+#endif /* !RINOO_IO_URING */
@@ -0,0 +1,314 @@
+/**
+ * @file   watchdog.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Scheduler watchdog functions
+ *
+ *
+ */
+
+#include "rinoo/scheduler/module.h"
+
+/**
+ * Reads the monotonic clock.
+ *
+ * @return Current time in ns
+ */
+static inline uint64_t rn_watchdog_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Gets the main scheduler, owning the watchdog.
+ *
+ * @param sched Pointer to a scheduler or one of its spawns
+ *
+ * @return Pointer to the main scheduler
+ */
+static rn_sched_t *rn_watchdog_owner(rn_sched_t *sched)
+{
+	while (sched->parent != NULL) {
+		sched = sched->parent;
+	}
+	return sched;
+}
+
+/**
+ * Signal handler capturing the stack of the task running in this thread.
+ *
+ * @param signum Signal number
+ */
+static void rn_watchdog_handler(int unused(signum))
+{
+	int error;
+	rn_task_t *task;
+	rn_watchdog_probe_t *probe;
+
+	task = rn_task_self();
+	if (task == NULL) {
+		return;
+	}
+	error = errno;
+	probe = &task->sched->wdog;
+	probe->report.task = task;
+	probe->report.nbframes = backtrace(probe->report.frames, RN_WATCHDOG_FRAMES);
+	__atomic_store_n(&probe->captured, true, __ATOMIC_RELEASE);
+	errno = error;
+}
+
+/**
+ * Checks whether a scheduler has been running the same task for too long.
+ * This is called with the family lock held, and only fills the report.
+ * When a stall is found, the probe is flagged as signaling, which keeps
+ * the scheduler thread in its loop until the stack has been captured.
+ *
+ * @param watchdog Pointer to the watchdog
+ * @param sched Pointer to the scheduler to check
+ * @param now Current time in ns
+ * @param report Pointer to the report to fill
+ *
+ * @return true if the scheduler is stalled, otherwise false
+ */
+static bool rn_watchdog_check(rn_watchdog_t *watchdog, rn_sched_t *sched, uint64_t now, rn_watchdog_report_t *report)
+{
+	rn_task_t *task;
+	uint64_t switches;
+	rn_watchdog_probe_t *probe;
+
+	probe = &sched->wdog;
+	if (!__atomic_load_n(&probe->running, __ATOMIC_ACQUIRE)) {
+		return false;
+	}
+	task = __atomic_load_n(&sched->driver.current, __ATOMIC_RELAXED);
+	switches = __atomic_load_n(&sched->stats.switches, __ATOMIC_RELAXED);
+	if (task == &sched->driver.main || task != probe->task || switches != probe->switches) {
+		probe->task = task;
+		probe->switches = switches;
+		probe->since = now;
+		probe->reported = false;
+		return false;
+	}
+	if (probe->reported || now - probe->since < watchdog->threshold) {
+		return false;
+	}
+	probe->reported = true;
+	report->sched = sched;
+	report->task = task;
+	report->function = task->function;
+	report->duration = now - probe->since;
+	report->nbframes = 0;
+	__atomic_store_n(&probe->captured, false, __ATOMIC_RELEASE);
+	__atomic_store_n(&probe->signaling, true, __ATOMIC_SEQ_CST);
+	if (!__atomic_load_n(&probe->running, __ATOMIC_SEQ_CST)) {
+		/* The loop is leaving, its thread may be gone */
+		__atomic_store_n(&probe->signaling, false, __ATOMIC_RELEASE);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Captures the stack of a stalled task by signaling its scheduler thread.
+ * This is called without the family lock, while the probe is signaling.
+ *
+ * @param probe Pointer to the stalled scheduler probe
+ * @param report Pointer to the report to complete
+ */
+static void rn_watchdog_capture(rn_watchdog_probe_t *probe, rn_watchdog_report_t *report)
+{
+	int i;
+
+	if (pthread_kill(probe->thread, RN_WATCHDOG_SIGNAL) == 0) {
+		for (i = 0; i < 100 && !__atomic_load_n(&probe->captured, __ATOMIC_ACQUIRE); i++) {
+			usleep(1000);
+		}
+		if (__atomic_load_n(&probe->captured, __ATOMIC_ACQUIRE) && probe->report.task == report->task) {
+			report->nbframes = probe->report.nbframes;
+			memcpy(report->frames, probe->report.frames, sizeof(*report->frames) * report->nbframes);
+		}
+	}
+	/* From now on, the scheduler may leave its loop and be destroyed */
+	__atomic_store_n(&probe->signaling, false, __ATOMIC_RELEASE);
+}
+
+/**
+ * Watchdog thread loop.
+ * The family lock is only held to look for stalls: stacks are captured
+ * and callbacks are called once it is released.
+ *
+ * @param arg Pointer to the watchdog
+ *
+ * @return NULL
+ */
+static void *rn_watchdog_loop(void *arg)
+{
+	int i;
+	int nbstalled;
+	uint64_t now;
+	uint64_t interval;
+	struct timespec ts;
+	void *ptr;
+	rn_sched_t *cur;
+	rn_watchdog_t *watchdog = arg;
+	rn_watchdog_report_t *reports;
+
+	interval = watchdog->threshold / 4;
+	if (interval < RN_NS_PER_MS) {
+		interval = RN_NS_PER_MS;
+	}
+	reports = NULL;
+	pthread_mutex_lock(&watchdog->lock);
+	while (!watchdog->stop) {
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_nsec += interval % 1000000000;
+		ts.tv_sec += interval / 1000000000 + ts.tv_nsec / 1000000000;
+		ts.tv_nsec %= 1000000000;
+		pthread_cond_timedwait(&watchdog->cond, &watchdog->lock, &ts);
+		if (watchdog->stop) {
+			break;
+		}
+		pthread_mutex_unlock(&watchdog->lock);
+		now = rn_watchdog_now();
+		nbstalled = 0;
+		/* Holding the family lock prevents spawns from being destroyed */
+		pthread_mutex_lock(&watchdog->sched->steal.family);
+		ptr = realloc(reports, sizeof(*reports) * (watchdog->sched->spawns.count + 1));
+		if (ptr != NULL) {
+			reports = ptr;
+			for (i = 0; i <= watchdog->sched->spawns.count; i++) {
+				cur = rn_spawn_get(watchdog->sched, i);
+				if (cur != NULL && rn_watchdog_check(watchdog, cur, now, &reports[nbstalled])) {
+					nbstalled++;
+				}
+			}
+		}
+		pthread_mutex_unlock(&watchdog->sched->steal.family);
+		for (i = 0; i < nbstalled; i++) {
+			rn_watchdog_capture(&reports[i].sched->wdog, &reports[i]);
+			watchdog->callback(&reports[i]);
+		}
+		pthread_mutex_lock(&watchdog->lock);
+	}
+	pthread_mutex_unlock(&watchdog->lock);
+	free(reports);
+	return NULL;
+}
+
+/**
+ * Starts a watchdog thread monitoring a scheduler and its spawns.
+ * The callback is called, from the watchdog thread, when a scheduler
+ * has been running the same task for more than `ms` milliseconds. The
+ * report holds the task entry point and a backtrace of its stack,
+ * captured with RN_WATCHDOG_SIGNAL. A task is reported once per stall.
+ * No scheduler lock is held while calling back, but the reported
+ * scheduler may have been retired by then.
+ * The application handler for RN_WATCHDOG_SIGNAL, if any, is replaced
+ * until the watchdog gets stopped.
+ *
+ * @param sched Pointer to the main scheduler
+ * @param ms Stall threshold in milliseconds
+ * @param callback Function to call when a stalled scheduler is found
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_watchdog_start(rn_sched_t *sched, uint32_t ms, rn_watchdog_cb_t callback)
+{
+	void *frame;
+	rn_watchdog_t *watchdog;
+	struct sigaction action;
+
+	XASSERT(sched != NULL, -1);
+	XASSERT(ms > 0, -1);
+	XASSERT(callback != NULL, -1);
+
+	sched = rn_watchdog_owner(sched);
+	if (sched->watchdog != NULL) {
+		rn_error_set(EBUSY);
+		return -1;
+	}
+	watchdog = calloc(1, sizeof(*watchdog));
+	if (watchdog == NULL) {
+		return -1;
+	}
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = rn_watchdog_handler;
+	action.sa_flags = SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	if (sigaction(RN_WATCHDOG_SIGNAL, &action, &watchdog->previous) != 0) {
+		free(watchdog);
+		return -1;
+	}
+	/* backtrace loads libgcc on first call, which is not signal safe */
+	backtrace(&frame, 1);
+	watchdog->threshold = RN_MS_TO_NS(ms);
+	watchdog->callback = callback;
+	watchdog->sched = sched;
+	pthread_mutex_init(&watchdog->lock, NULL);
+	pthread_cond_init(&watchdog->cond, NULL);
+	if (pthread_create(&watchdog->thread, NULL, rn_watchdog_loop, watchdog) != 0) {
+		sigaction(RN_WATCHDOG_SIGNAL, &watchdog->previous, NULL);
+		pthread_cond_destroy(&watchdog->cond);
+		pthread_mutex_destroy(&watchdog->lock);
+		free(watchdog);
+		return -1;
+	}
+	sched->watchdog = watchdog;
+	return 0;
+}
+
+/**
+ * Stops the watchdog of a scheduler.
+ *
+ * @param sched Pointer to the main scheduler
+ */
+void rn_watchdog_stop(rn_sched_t *sched)
+{
+	rn_watchdog_t *watchdog;
+
+	XASSERTN(sched != NULL);
+
+	watchdog = sched->watchdog;
+	if (watchdog == NULL) {
+		return;
+	}
+	pthread_mutex_lock(&watchdog->lock);
+	watchdog->stop = true;
+	pthread_cond_signal(&watchdog->cond);
+	pthread_mutex_unlock(&watchdog->lock);
+	pthread_join(watchdog->thread, NULL);
+	sigaction(RN_WATCHDOG_SIGNAL, &watchdog->previous, NULL);
+	pthread_cond_destroy(&watchdog->cond);
+	pthread_mutex_destroy(&watchdog->lock);
+	free(watchdog);
+	sched->watchdog = NULL;
+}
+
+/**
+ * Marks the calling thread as running a scheduler loop.
+ *
+ * @param sched Pointer to the scheduler starting its loop
+ */
+void rn_watchdog_enter(rn_sched_t *sched)
+{
+	sched->wdog.thread = pthread_self();
+	__atomic_store_n(&sched->wdog.running, true, __ATOMIC_RELEASE);
+}
+
+/**
+ * Marks a scheduler loop as over.
+ *
+ * @param sched Pointer to the scheduler ending its loop
+ */
+void rn_watchdog_leave(rn_sched_t *sched)
+{
+	__atomic_store_n(&sched->wdog.running, false, __ATOMIC_SEQ_CST);
+	/* The watchdog may be about to signal this thread */
+	while (__atomic_load_n(&sched->wdog.signaling, __ATOMIC_SEQ_CST)) {
+		sched_yield();
+	}
+}
@@ -0,0 +1,144 @@
+/**
+ * @file   histogram.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Log-linear histogram
+ *
+ *
+ */
+
+#include "rinoo/struct/module.h"
+
+/**
+ * Gets the bucket index of a value.
+ *
+ * @param value Value to record
+ *
+ * @return Bucket index
+ */
+static inline uint32_t rn_histogram_index(uint64_t value)
+{
+	uint32_t shift;
+
+	if (value < RN_HISTOGRAM_SUB) {
+		return value;
+	}
+	shift = 63 - __builtin_clzll(value) - RN_HISTOGRAM_SUBBITS;
+	return (shift + 1) * RN_HISTOGRAM_SUB + ((value >> shift) & (RN_HISTOGRAM_SUB - 1));
+}
+
+/**
+ * Gets the highest value recorded in a bucket.
+ *
+ * @param index Bucket index
+ *
+ * @return Highest value of the bucket
+ */
+static inline uint64_t rn_histogram_value(uint32_t index)
+{
+	uint32_t shift;
+
+	if (index < RN_HISTOGRAM_SUB) {
+		return index;
+	}
+	shift = index / RN_HISTOGRAM_SUB - 1;
+	return ((((uint64_t) RN_HISTOGRAM_SUB + index % RN_HISTOGRAM_SUB) << shift) - 1) + ((uint64_t) 1 << shift);
+}
+
+/**
+ * Initializes or resets a histogram.
+ *
+ * @param histogram Pointer to the histogram to initialize
+ */
+void rn_histogram(rn_histogram_t *histogram)
+{
+	XASSERTN(histogram != NULL);
+
+	memset(histogram, 0, sizeof(*histogram));
+	histogram->min = UINT64_MAX;
+}
+
+/**
+ * Records a value in a histogram.
+ *
+ * @param histogram Pointer to the histogram to use
+ * @param value Value to record
+ */
+void rn_histogram_add(rn_histogram_t *histogram, uint64_t value)
+{
+	histogram->buckets[rn_histogram_index(value)]++;
+	histogram->count++;
+	histogram->sum += value;
+	if (value < histogram->min) {
+		histogram->min = value;
+	}
+	if (value > histogram->max) {
+		histogram->max = value;
+	}
+}
+
+/**
+ * Adds all values recorded in a histogram to another one.
+ *
+ * @param dst Pointer to the histogram to add values to
+ * @param src Pointer to the histogram to read values from
+ */
+void rn_histogram_merge(rn_histogram_t *dst, const rn_histogram_t *src)
+{
+	uint32_t i;
+
+	XASSERTN(dst != NULL);
+	XASSERTN(src != NULL);
+
+	for (i = 0; i < RN_HISTOGRAM_SIZE; i++) {
+		dst->buckets[i] += src->buckets[i];
+	}
+	dst->count += src->count;
+	dst->sum += src->sum;
+	if (src->min < dst->min) {
+		dst->min = src->min;
+	}
+	if (src->max > dst->max) {
+		dst->max = src->max;
+	}
+}
+
+/**
+ * Gets the value below which a percentage of recorded values fall.
+ *
+ * @param histogram Pointer to the histogram to use
+ * @param percentile Percentage, between 0 and 100
+ *
+ * @return Highest value of the bucket holding the percentile, or 0 if the histogram is empty
+ */
+uint64_t rn_histogram_percentile(const rn_histogram_t *histogram, double percentile)
+{
+	uint32_t i;
+	uint64_t rank;
+	uint64_t count;
+
+	XASSERT(histogram != NULL, 0);
+
+	if (histogram->count == 0) {
+		return 0;
+	}
+	if (percentile >= 100) {
+		return histogram->max;
+	}
+	rank = (uint64_t) (percentile * histogram->count / 100);
+	if (rank == 0) {
+		rank = 1;
+	}
+	count = 0;
+	for (i = 0; i < RN_HISTOGRAM_SIZE; i++) {
+		count += histogram->buckets[i];
+		if (count >= rank) {
+			break;
+		}
+	}
+	if (rn_histogram_value(i) > histogram->max) {
+		return histogram->max;
+	}
+	return rn_histogram_value(i);
+}
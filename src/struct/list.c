@@ -89,6 +89,26 @@ void rn_list_put(rn_list_t *rn_list, rn_list_node_t *node)
 	rn_list->size++;
 }
 
+/**
+ * Adds an element at the end of a rn_list.
+ * The compare function, if any, is ignored.
+ *
+ * @param rn_list Pointer to the rn_list
+ * @param node Pointer to the node to add
+ */
+void rn_list_append(rn_list_t *rn_list, rn_list_node_t *node)
+{
+	node->next = NULL;
+	node->prev = rn_list->tail;
+	if (rn_list->tail == NULL) {
+		rn_list->head = node;
+	} else {
+		rn_list->tail->next = node;
+	}
+	rn_list->tail = node;
+	rn_list->size++;
+}
+
 /**
  * Gets a node from a rn_list.
  *
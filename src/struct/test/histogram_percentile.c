@@ -0,0 +1,54 @@
+/**
+ * @file   histogram_percentile.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  rn_histogram_percentile unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+/**
+ * Main function for this unit test.
+ *
+ * @return 0 if test passed
+ */
+int main()
+{
+	uint64_t i;
+	uint64_t value;
+	rn_histogram_t histogram;
+	rn_histogram_t other;
+
+	rn_histogram(&histogram);
+	XTEST(rn_histogram_percentile(&histogram, 50) == 0);
+	for (i = 1; i <= 1000; i++) {
+		rn_histogram_add(&histogram, i * 1000);
+	}
+	XTEST(histogram.count == 1000);
+	XTEST(histogram.min == 1000);
+	XTEST(histogram.max == 1000000);
+	/* Values are recorded with a relative error below 1/16 */
+	value = rn_histogram_percentile(&histogram, 50);
+	XTEST(value >= 500000 && value <= 500000 + 500000 / 16);
+	value = rn_histogram_percentile(&histogram, 99);
+	XTEST(value >= 990000 && value <= 1000000);
+	XTEST(rn_histogram_percentile(&histogram, 100) == 1000000);
+	value = rn_histogram_percentile(&histogram, 0);
+	XTEST(value >= 1000 && value <= 1000 + 1000 / 16);
+	/* Small values are exact */
+	rn_histogram(&other);
+	for (i = 0; i < 10; i++) {
+		rn_histogram_add(&other, i);
+	}
+	XTEST(rn_histogram_percentile(&other, 50) == 4);
+	rn_histogram_add(&other, UINT64_MAX);
+	XTEST(rn_histogram_percentile(&other, 100) == UINT64_MAX);
+	rn_histogram_merge(&histogram, &other);
+	XTEST(histogram.count == 1011);
+	XTEST(histogram.min == 0);
+	XTEST(histogram.max == UINT64_MAX);
+	XPASS();
+}
@@ -0,0 +1,50 @@
+/**
+ * @file   list_append.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  rinoo rn_list append unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define RN_LISTTEST_NB_ELEM 10000
+
+typedef struct mytest
+{
+	int val;
+	rn_list_node_t node;
+} tmytest;
+
+int main()
+{
+	int i;
+	tmytest *elem;
+	rn_list_t mylist;
+	rn_list_node_t *node;
+	tmytest tab[RN_LISTTEST_NB_ELEM];
+
+	XTEST(rn_list(&mylist, NULL) == 0);
+	for (i = 0; i < RN_LISTTEST_NB_ELEM; i++) {
+		tab[i].val = i;
+		rn_list_append(&mylist, &tab[i].node);
+		XTEST(mylist.tail == &tab[i].node);
+		XTEST(mylist.head == &tab[0].node);
+	}
+	XTEST(rn_list_size(&mylist) == RN_LISTTEST_NB_ELEM);
+	XTEST(rn_list_remove(&mylist, &tab[RN_LISTTEST_NB_ELEM / 2].node) == 0);
+	for (i = 0; i < RN_LISTTEST_NB_ELEM; i++) {
+		if (i == RN_LISTTEST_NB_ELEM / 2) {
+			continue;
+		}
+		node = rn_list_pop(&mylist);
+		XTEST(node != NULL);
+		elem = container_of(node, tmytest, node);
+		XTEST(elem->val == i);
+	}
+	XTEST(rn_list_pop(&mylist) == NULL);
+	XTEST(mylist.tail == NULL);
+	XPASS();
+}
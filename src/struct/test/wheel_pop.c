@@ -0,0 +1,89 @@
+/**
+ * @file   wheel_pop.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  rinoo rn_wheel pop unit test
+ *
+ *
+ */
+
+#include "rinoo/rinoo.h"
+
+#define RN_WHEELTEST_NB_ELEM		10000
+
+typedef struct mytest
+{
+	int val;
+	rn_wheel_node_t node;
+} tmytest;
+
+tmytest tab[RN_WHEELTEST_NB_ELEM];
+
+int main()
+{
+	int i;
+	int nb;
+	uint64_t now;
+	uint64_t last;
+	rn_wheel_t wheel;
+	rn_wheel_node_t *node;
+
+	/* Same tick, popped in insertion order */
+	XTEST(rn_wheel(&wheel, 1000) == 0);
+	XTEST(rn_wheel_next(&wheel) == UINT64_MAX);
+	for (i = 0; i < 10; i++) {
+		tab[i].val = i;
+		rn_wheel_put(&wheel, &tab[i].node, 1005);
+	}
+	rn_wheel_remove(&wheel, &tab[3].node);
+	XTEST(wheel.size == 9);
+	XTEST(rn_wheel_next(&wheel) == 1005);
+	XTEST(rn_wheel_pop(&wheel, 1004) == NULL);
+	for (i = 0; i < 10; i++) {
+		if (i == 3) {
+			continue;
+		}
+		node = rn_wheel_pop(&wheel, 1005);
+		XTEST(node != NULL);
+		XTEST(container_of(node, tmytest, node)->val == i);
+	}
+	XTEST(rn_wheel_pop(&wheel, 1005) == NULL);
+	XTEST(wheel.size == 0);
+
+	/* Expired nodes are popped right away */
+	rn_wheel_put(&wheel, &tab[0].node, 0);
+	XTEST(rn_wheel_pop(&wheel, wheel.now) == &tab[0].node);
+
+	/* Random expiry times across all levels */
+	now = 123456;
+	XTEST(rn_wheel(&wheel, now) == 0);
+	for (i = 0; i < RN_WHEELTEST_NB_ELEM; i++) {
+		tab[i].val = random() % (1 << (6 * (1 + i % 4)));
+		rn_wheel_put(&wheel, &tab[i].node, now + tab[i].val);
+	}
+	for (i = 0; i < RN_WHEELTEST_NB_ELEM; i += 7) {
+		rn_wheel_remove(&wheel, &tab[i].node);
+	}
+	nb = wheel.size;
+	last = 0;
+	while (wheel.size > 0) {
+		now += random() % 5000;
+		XTEST(rn_wheel_next(&wheel) >= wheel.now);
+		while ((node = rn_wheel_pop(&wheel, now)) != NULL) {
+			XTEST(node->expire <= now);
+			XTEST(node->expire >= last);
+			last = node->expire;
+			nb--;
+		}
+		for (i = 0; i < RN_WHEELTEST_NB_ELEM; i++) {
+			if (tab[i].node.slot != NULL) {
+				XTEST(tab[i].node.expire > now);
+			}
+		}
+	}
+	XTEST(nb == 0);
+	rn_wheel_flush(&wheel);
+	XTEST(rn_wheel_next(&wheel) == UINT64_MAX);
+	XPASS();
+}
@@ -0,0 +1,272 @@
+/**
+ * @file   wheel.c
+ * @author Reginald Lips <reginald.l@gmail.com> - Copyright 2013
+ * @date   Wed Feb  1 18:56:27 2017
+ *
+ * @brief  Hierarchical timing wheel implementation.
+ *
+ *
+ */
+
+#include "rinoo/struct/module.h"
+
+#define RN_WHEEL_SHIFT(level)	(RN_WHEEL_BITS * (level))
+#define RN_WHEEL_RANGE		(1ULL << RN_WHEEL_SHIFT(RN_WHEEL_LEVELS))
+
+/**
+ * Links a node into the slot matching its expiry time.
+ *
+ * @param wheel Pointer to the wheel to use
+ * @param node Pointer to the node to link
+ */
+static void rn_wheel_link(rn_wheel_t *wheel, rn_wheel_node_t *node)
+{
+	int level;
+	uint64_t index;
+	uint64_t delta;
+	uint64_t expire;
+	rn_wheel_slot_t *slot;
+
+	expire = node->expire;
+	if (expire < wheel->now) {
+		expire = wheel->now;
+	}
+	delta = expire - wheel->now;
+	if (delta >= RN_WHEEL_RANGE) {
+		/* Out of range, the node will be cascaded again later */
+		expire = wheel->now + RN_WHEEL_RANGE - 1;
+		delta = RN_WHEEL_RANGE - 1;
+	}
+	for (level = 0; level < RN_WHEEL_LEVELS - 1; level++) {
+		if (delta < (1ULL << RN_WHEEL_SHIFT(level + 1))) {
+			break;
+		}
+	}
+	index = (expire >> RN_WHEEL_SHIFT(level)) & RN_WHEEL_MASK;
+	slot = &wheel->slots[level][index];
+	node->slot = slot;
+	node->next = NULL;
+	node->prev = slot->tail;
+	if (slot->tail != NULL) {
+		slot->tail->next = node;
+	} else {
+		slot->head = node;
+	}
+	slot->tail = node;
+	wheel->bitmap[level] |= (1ULL << index);
+}
+
+/**
+ * Unlinks a node from its slot.
+ *
+ * @param wheel Pointer to the wheel to use
+ * @param node Pointer to the node to unlink
+ */
+static void rn_wheel_unlink(rn_wheel_t *wheel, rn_wheel_node_t *node)
+{
+	size_t index;
+	rn_wheel_slot_t *slot;
+
+	slot = node->slot;
+	if (node->prev != NULL) {
+		node->prev->next = node->next;
+	} else {
+		slot->head = node->next;
+	}
+	if (node->next != NULL) {
+		node->next->prev = node->prev;
+	} else {
+		slot->tail = node->prev;
+	}
+	if (slot->head == NULL) {
+		index = slot - &wheel->slots[0][0];
+		wheel->bitmap[index / RN_WHEEL_SLOTS] &= ~(1ULL << (index % RN_WHEEL_SLOTS));
+	}
+	node->prev = NULL;
+	node->next = NULL;
+	node->slot = NULL;
+}
+
+/**
+ * Moves nodes from upper levels down to the lower ones.
+ * This must be called each time the wheel reaches a level 0 boundary.
+ *
+ * @param wheel Pointer to the wheel to use
+ */
+static void rn_wheel_cascade(rn_wheel_t *wheel)
+{
+	int level;
+	uint64_t index;
+	rn_wheel_node_t *node;
+	rn_wheel_node_t *next;
+
+	for (level = 1; level < RN_WHEEL_LEVELS; level++) {
+		index = (wheel->now >> RN_WHEEL_SHIFT(level)) & RN_WHEEL_MASK;
+		node = wheel->slots[level][index].head;
+		wheel->slots[level][index].head = NULL;
+		wheel->slots[level][index].tail = NULL;
+		wheel->bitmap[level] &= ~(1ULL << index);
+		while (node != NULL) {
+			next = node->next;
+			rn_wheel_link(wheel, node);
+			node = next;
+		}
+		if (index != 0) {
+			break;
+		}
+	}
+}
+
+/**
+ * Initializes a timing wheel.
+ *
+ * @param wheel Pointer to the wheel to initialize
+ * @param now Current time, in ticks
+ *
+ * @return 0 on success, otherwise -1
+ */
+int rn_wheel(rn_wheel_t *wheel, uint64_t now)
+{
+	XASSERT(wheel != NULL, -1);
+
+	memset(wheel, 0, sizeof(*wheel));
+	wheel->now = now;
+	return 0;
+}
+
+/**
+ * Removes all nodes from a timing wheel.
+ *
+ * @param wheel Pointer to the wheel to flush
+ */
+void rn_wheel_flush(rn_wheel_t *wheel)
+{
+	int level;
+	int index;
+	rn_wheel_node_t *node;
+
+	for (level = 0; level < RN_WHEEL_LEVELS; level++) {
+		for (index = 0; index < RN_WHEEL_SLOTS; index++) {
+			while ((node = wheel->slots[level][index].head) != NULL) {
+				rn_wheel_unlink(wheel, node);
+			}
+		}
+	}
+	wheel->size = 0;
+}
+
+/**
+ * Adds a node to a timing wheel.
+ * A node expiring in the past expires on the next call to rn_wheel_pop.
+ * Nodes expiring at the same tick are popped in insertion order.
+ *
+ * @param wheel Pointer to the wheel to use
+ * @param node Pointer to the node to add
+ * @param expire Expiry time, in ticks
+ */
+void rn_wheel_put(rn_wheel_t *wheel, rn_wheel_node_t *node, uint64_t expire)
+{
+	if (node->slot != NULL) {
+		rn_wheel_unlink(wheel, node);
+		wheel->size--;
+	}
+	node->expire = expire;
+	rn_wheel_link(wheel, node);
+	wheel->size++;
+}
+
+/**
+ * Removes a node from a timing wheel.
+ *
+ * @param wheel Pointer to the wheel to use
+ * @param node Pointer to the node to remove
+ */
+void rn_wheel_remove(rn_wheel_t *wheel, rn_wheel_node_t *node)
+{
+	if (node->slot == NULL) {
+		return;
+	}
+	rn_wheel_unlink(wheel, node);
+	wheel->size--;
+}
+
+/**
+ * Advances a timing wheel and pops the next expired node.
+ *
+ * @param wheel Pointer to the wheel to use
+ * @param now Current time, in ticks
+ *
+ * @return Pointer to an expired node, or NULL if no node has expired
+ */
+rn_wheel_node_t *rn_wheel_pop(rn_wheel_t *wheel, uint64_t now)
+{
+	uint64_t next;
+	rn_wheel_node_t *node;
+
+	while (1) {
+		node = wheel->slots[0][wheel->now & RN_WHEEL_MASK].head;
+		if (node != NULL) {
+			rn_wheel_unlink(wheel, node);
+			wheel->size--;
+			return node;
+		}
+		if (wheel->now >= now) {
+			return NULL;
+		}
+		/* Empty slots are skipped, so we jump to the next one to process */
+		next = rn_wheel_next(wheel);
+		if (next > now) {
+			wheel->now = now;
+			return NULL;
+		}
+		wheel->now = next;
+		if ((wheel->now & RN_WHEEL_MASK) == 0) {
+			rn_wheel_cascade(wheel);
+		}
+	}
+}
+
+/**
+ * Gets the next tick at which the wheel has work to do.
+ * This is either the expiry time of the next node or the time
+ * at which an upper level slot has to be cascaded, so that the
+ * returned value never exceeds the next expiry time.
+ *
+ * @param wheel Pointer to the wheel to use
+ *
+ * @return Next tick to process, or UINT64_MAX if the wheel is empty
+ */
+uint64_t rn_wheel_next(rn_wheel_t *wheel)
+{
+	int level;
+	uint64_t pos;
+	uint64_t tick;
+	uint64_t next;
+	uint64_t offset;
+	uint64_t bitmap;
+
+	next = UINT64_MAX;
+	for (level = 0; level < RN_WHEEL_LEVELS; level++) {
+		if (wheel->bitmap[level] == 0) {
+			continue;
+		}
+		pos = (wheel->now >> RN_WHEEL_SHIFT(level)) & RN_WHEEL_MASK;
+		bitmap = wheel->bitmap[level];
+		if (pos != 0) {
+			bitmap = (bitmap >> pos) | (bitmap << (RN_WHEEL_SLOTS - pos));
+		}
+		if (level == 0) {
+			offset = __builtin_ctzll(bitmap);
+			tick = wheel->now + offset;
+		} else {
+			/* Current slot of an upper level is only cascaded on the next round */
+			bitmap &= ~1ULL;
+			offset = (bitmap == 0 ? RN_WHEEL_SLOTS : (uint64_t) __builtin_ctzll(bitmap));
+			tick = ((wheel->now >> RN_WHEEL_SHIFT(level)) + offset) << RN_WHEEL_SHIFT(level);
+		}
+		if (tick < next) {
+			next = tick;
+		}
+	}
+	return next;
+}